@@ -0,0 +1,76 @@
+# Adds crow::websocket::connection::buffered_amount(): the bytes queued by
+# send_* that the socket has not accepted yet. Crow's sends only append to
+# the connection's write buffer, so without it a slow client is invisible to
+# the server until the buffer has grown without bound.
+#
+# Run as the Crow FetchContent PATCH_COMMAND (working directory = Crow source).
+# All-or-nothing: if any anchor is missing (a different Crow release), the
+# header is left untouched with a warning. WsFanout detects the accessor at
+# compile time, so the server still builds and only loses the byte cap.
+
+set(header "${CMAKE_CURRENT_SOURCE_DIR}/include/crow/websocket.h")
+if(NOT EXISTS "${header}")
+  message(WARNING "patch_crow_websocket: ${header} not found, WebSocket backlog cap disabled")
+  return()
+endif()
+file(READ "${header}" content)
+
+if(content MATCHES "buffered_amount")
+  return()
+endif()
+
+# Each anchor is checked before anything is replaced. Kept in separate
+# variables rather than a list since the code contains semicolons.
+set(anchor_pragma "#pragma once")
+set(anchor_base "virtual std::string get_remote_ip\\(\\) = 0;")
+set(anchor_write "void do_write\\(\\)([ \t\r\n]*){")
+set(anchor_release "sending_buffers_\\.clear\\(\\);")
+
+set(missing "")
+foreach(anchor anchor_pragma anchor_base anchor_write anchor_release)
+  if(NOT content MATCHES "${${anchor}}")
+    list(APPEND missing "${anchor}")
+  endif()
+endforeach()
+foreach(member write_buffers_ sending_buffers_)
+  if(NOT content MATCHES "${member}")
+    list(APPEND missing "${member}")
+  endif()
+endforeach()
+
+if(missing)
+  message(WARNING "patch_crow_websocket: ${header} does not match (missing: ${missing}), "
+                  "left unpatched; WebSocket backlog cap disabled")
+  return()
+endif()
+
+string(REGEX REPLACE "${anchor_pragma}" "#pragma once\n#include <atomic>" content "${content}")
+
+# Public accessor on the base class handed to user callbacks
+string(REGEX REPLACE "${anchor_base}" "virtual std::string get_remote_ip() = 0;
+
+            /// Bytes queued by send_* that the socket has not accepted yet
+            std::size_t buffered_amount() const { return buffered_amount_.load(std::memory_order_relaxed); }
+
+        protected:
+            std::atomic<std::size_t> buffered_amount_{0};
+
+        public:" content "${content}")
+
+# Recount on every enqueue (send_* always ends in do_write) ...
+string(REGEX REPLACE "${anchor_write}" "void update_buffered_amount()
+            {
+                std::size_t bytes = 0;
+                for (const auto& buffer : write_buffers_) bytes += buffer.size();
+                for (const auto& buffer : sending_buffers_) bytes += buffer.size();
+                buffered_amount_.store(bytes, std::memory_order_relaxed);
+            }
+
+            void do_write()\\1{
+                update_buffered_amount();" content "${content}")
+
+# ... and whenever a write completes and its buffers are released
+string(REGEX REPLACE "${anchor_release}" "sending_buffers_.clear(), update_buffered_amount();" content "${content}")
+
+file(WRITE "${header}" "${content}")
+message(STATUS "Patched ${header} with websocket buffered_amount()")
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Placement and wait policy for one class of engine thread
+struct ThreadRoleConfig {
+    std::vector<int> cores;   // empty = let the OS schedule freely
+    bool busyPoll = false;    // spin on the hand-off instead of sleeping
+    bool numaLocal = false;   // bind allocations to the node of the pinned core
+};
+
+// Typed view of config.json. Missing keys keep the defaults below, so an
+// older config file (or none at all) still starts the server.
+struct EngineConfig {
+    // server
+    std::string host = "0.0.0.0";
+    int port = 5002;
+    int httpThreads = 4;
+
+    // market
+    int updateIntervalMs = 3000;
+    double defaultVolatility = 0.25;
+    double defaultRate = 0.064;
+    int defaultTimeToExpiryDays = 30;
+    int exchangeUtcOffsetMinutes = 330;          // IST
+    std::vector<std::string> exchangeHolidays;   // "YYYY-MM-DD" in exchange time
+
+    // calculations
+    int monteCarloSimulations = 100000;
+    int precisionDecimals = 4;
+    bool enableParallelProcessing = true;
+
+    // websocket
+    int maxConnections = 1000;
+    int heartbeatIntervalSec = 30;
+    int sendQueueInstruments = 4096;
+    std::string slowConsumerPolicy = "downgrade";  // "drop" or "downgrade"
+    int slowConsumerLagCycles = 5;
+    int downgradeInterval = 5;
+    int slowConsumerKb = 256;
+    int maxBufferedKb = 4096;
+    int senderThreads = 2;
+
+    // history
+    bool historyEnabled = true;
+    int historySampleIntervalMs = 1000;
+    int historyChunkPoints = 3600;
+    int historyRetentionHours = 24;
+
+    // thread topology
+    ThreadRoleConfig feed;
+    ThreadRoleConfig calc;
+    ThreadRoleConfig broadcast;
+    ThreadRoleConfig sender;   // WebSocket sender pool
+    ThreadRoleConfig http;
+
+    static EngineConfig load(const std::string& path) {
+        EngineConfig config;
+
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Config file " << path << " not found, using defaults" << std::endl;
+            return config;
+        }
+
+        try {
+            nlohmann::json root = nlohmann::json::parse(file);
+
+            if (root.contains("server")) {
+                const auto& server = root["server"];
+                config.host = server.value("host", config.host);
+                config.port = server.value("port", config.port);
+                config.httpThreads = server.value("threads", config.httpThreads);
+            }
+            if (root.contains("market")) {
+                const auto& market = root["market"];
+                config.updateIntervalMs = market.value("update_interval_ms", config.updateIntervalMs);
+                config.defaultVolatility = market.value("default_volatility", config.defaultVolatility);
+                config.defaultRate = market.value("default_rate", config.defaultRate);
+                config.defaultTimeToExpiryDays = market.value("default_time_to_expiry", config.defaultTimeToExpiryDays);
+                config.exchangeUtcOffsetMinutes = market.value("utc_offset_minutes", config.exchangeUtcOffsetMinutes);
+                config.exchangeHolidays = market.value("holidays", config.exchangeHolidays);
+            }
+            if (root.contains("calculations")) {
+                const auto& calculations = root["calculations"];
+                config.monteCarloSimulations = calculations.value("monte_carlo_simulations", config.monteCarloSimulations);
+                config.precisionDecimals = calculations.value("precision_decimals", config.precisionDecimals);
+                config.enableParallelProcessing = calculations.value("enable_parallel_processing", config.enableParallelProcessing);
+            }
+            if (root.contains("websocket")) {
+                const auto& websocket = root["websocket"];
+                config.maxConnections = websocket.value("max_connections", config.maxConnections);
+                config.heartbeatIntervalSec = websocket.value("heartbeat_interval", config.heartbeatIntervalSec);
+                config.sendQueueInstruments = websocket.value("send_queue_instruments", config.sendQueueInstruments);
+                config.slowConsumerPolicy = websocket.value("slow_consumer_policy", config.slowConsumerPolicy);
+                config.slowConsumerLagCycles = websocket.value("slow_consumer_lag_cycles", config.slowConsumerLagCycles);
+                config.downgradeInterval = websocket.value("downgrade_interval", config.downgradeInterval);
+                config.slowConsumerKb = websocket.value("slow_consumer_kb", config.slowConsumerKb);
+                config.maxBufferedKb = websocket.value("max_buffered_kb", config.maxBufferedKb);
+                config.senderThreads = websocket.value("sender_threads", config.senderThreads);
+            }
+            if (root.contains("history")) {
+                const auto& history = root["history"];
+                config.historyEnabled = history.value("enabled", config.historyEnabled);
+                config.historySampleIntervalMs = history.value("sample_interval_ms", config.historySampleIntervalMs);
+                config.historyChunkPoints = history.value("chunk_points", config.historyChunkPoints);
+                config.historyRetentionHours = history.value("retention_hours", config.historyRetentionHours);
+            }
+            if (root.contains("topology")) {
+                const auto& topology = root["topology"];
+                readRole(topology, "feed", config.feed);
+                readRole(topology, "calc", config.calc);
+                readRole(topology, "broadcast", config.broadcast);
+                readRole(topology, "sender", config.sender);
+                readRole(topology, "http", config.http);
+                if (config.sender.busyPoll) {
+                    // Senders block on their ready queue; there is no spin mode to enable
+                    std::cerr << "topology.sender.busy_poll is not supported and is ignored" << std::endl;
+                    config.sender.busyPoll = false;
+                }
+                if (config.http.busyPoll) {
+                    // Crow's asio workers always block in run(); there is no spin mode to enable
+                    std::cerr << "topology.http.busy_poll is not supported and is ignored" << std::endl;
+                    config.http.busyPoll = false;
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to parse " << path << ": " << e.what() << ", using defaults" << std::endl;
+            return EngineConfig{};
+        }
+
+        return config;
+    }
+
+private:
+    static void readRole(const nlohmann::json& topology, const char* name, ThreadRoleConfig& role) {
+        if (!topology.contains(name)) return;
+
+        const auto& node = topology[name];
+        role.cores = node.value("cores", role.cores);
+        role.busyPoll = node.value("busy_poll", role.busyPoll);
+        role.numaLocal = node.value("numa_local", role.numaLocal);
+    }
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Multi-producer event queue feeding the engine's dispatcher thread.
+// Producers (timer thread, HTTP handlers, feed) push; the dispatcher drains
+// in batches so one lock acquisition covers a burst of events.
+template <typename Event>
+class EventQueue {
+public:
+    void push(Event event) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            events_.push_back(std::move(event));
+        }
+        ready_.notify_one();
+    }
+
+    void pushAll(std::vector<Event>& events) {
+        if (events.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& event : events) {
+                events_.push_back(std::move(event));
+            }
+        }
+        events.clear();
+        ready_.notify_one();
+    }
+
+    // Moves up to `maxEvents` pending events into `out`, waiting up to
+    // `timeout` for the first one. Returns false if nothing arrived or the
+    // queue was closed.
+    template <typename Rep, typename Period>
+    bool drain(std::vector<Event>& out, std::chrono::duration<Rep, Period> timeout,
+               size_t maxEvents = static_cast<size_t>(-1)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait_for(lock, timeout, [this] { return closed_ || !events_.empty(); });
+        if (events_.empty()) return false;
+
+        size_t count = std::min(maxEvents, events_.size());
+        out.reserve(out.size() + count);
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(std::move(events_.front()));
+            events_.pop_front();
+        }
+        if (!events_.empty()) ready_.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+    bool closed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<Event> events_;
+    bool closed_ = false;
+};
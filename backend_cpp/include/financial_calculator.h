@@ -0,0 +1,53 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// Financial calculation class with optimized algorithms. Built as the
+// thv_analytics library so the server and the Python bindings share one
+// implementation of every pricing routine.
+class FinancialCalculator {
+private:
+    // Fast inverse normal CDF approximation
+    static double inverseNormalCDF(double p);
+
+    // Standard normal CDF
+    static double normalCDF(double x);
+
+public:
+    // High-performance Black-Scholes calculation
+    static double blackScholesCall(double S, double K, double r, double T, double sigma);
+
+    static double blackScholesPut(double S, double K, double r, double T, double sigma);
+
+    // Implied volatility from an option price: Newton on vega, falling back
+    // to bisection when a step leaves the bracket. Returns 0 if unattainable.
+    static double impliedVolatility(double price, double S, double K, double r, double T, bool isCall);
+
+    // Vectorized calculations for multiple instruments
+    static nlohmann::json calculateBatchMetrics(const std::vector<double>& spots, const std::vector<double>& rates,
+                                                const std::vector<double>& times, const std::vector<double>& volatilities);
+
+    // Raw-array batch kernels. Every array holds `n` contiguous elements and
+    // outputs are written in place, so callers can pass buffers they already
+    // own (NumPy arrays, column stores) without copying. `threads` <= 0 lets
+    // OpenMP choose; builds without OpenMP run serially.
+    static void priceBatch(const double* spots, const double* strikes, const double* rates,
+                           const double* times, const double* volatilities, size_t n,
+                           double* calls, double* puts, int threads = 0);
+
+    static void impliedVolatilityBatch(const double* prices, const double* spots, const double* strikes,
+                                       const double* rates, const double* times, const bool* isCall,
+                                       size_t n, double* volatilities, int threads = 0);
+
+    // Theoretical future value and one-standard-deviation move per instrument
+    static void futuresMetricsBatch(const double* spots, const double* rates, const double* times,
+                                    const double* volatilities, size_t n,
+                                    double* theoretical, double* oneSdv, int threads = 0);
+
+    // Monte Carlo simulation for complex instruments
+    static double monteCarloOptionPrice(double S, double K, double r, double T, double sigma,
+                                        int simulations = 100000, bool isCall = true);
+};
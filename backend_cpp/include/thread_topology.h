@@ -0,0 +1,146 @@
+#pragma once
+
+#include "engine_config.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// Pause hint for spin loops; keeps the sibling hyperthread fed and avoids
+// memory-order machine clears when the polled value finally changes.
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Restricts the calling thread to the given cores. Threads created afterwards
+// from this thread inherit the mask on Linux, which is how Crow's workers get
+// placed. Returns false if the platform refused or does not support it.
+inline bool pinCurrentThread(const std::vector<int>& cores) {
+    if (cores.empty()) return true;
+
+#if defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int core : cores) {
+        if (core >= 0 && core < static_cast<int>(sizeof(DWORD_PTR) * 8)) mask |= DWORD_PTR(1) << core;
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : cores) {
+        if (core >= 0 && core < CPU_SETSIZE) CPU_SET(core, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+// Makes the calling thread's future page faults allocate on the NUMA node it
+// is running on. Only meaningful after pinning; no-op off Linux.
+inline bool bindMemoryToLocalNode() {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    const int mpolLocal = 4;  // MPOL_LOCAL from <linux/mempolicy.h>
+    return syscall(SYS_set_mempolicy, mpolLocal, nullptr, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+inline void applyThreadRole(const std::string& name, const ThreadRoleConfig& role) {
+    if (!role.cores.empty() && !pinCurrentThread(role.cores)) {
+        std::cerr << "Failed to pin " << name << " thread" << std::endl;
+    }
+    if (role.numaLocal && !bindMemoryToLocalNode()) {
+        std::cerr << "NUMA-local allocation unavailable for " << name << " thread" << std::endl;
+    }
+}
+
+// Waits until `deadline`, either in the kernel or spinning on the clock.
+// Spinning trades a core for wake-up jitter in the tens of microseconds.
+template <typename Clock, typename Duration>
+void waitUntil(std::chrono::time_point<Clock, Duration> deadline, bool busyPoll) {
+    if (!busyPoll) {
+        std::this_thread::sleep_until(deadline);
+        return;
+    }
+    while (Clock::now() < deadline) {
+        cpuRelax();
+    }
+}
+
+// Single-slot, latest-value hand-off between pipeline threads. Producers
+// overwrite; consumers only ever see the newest value, so a slow stage skips
+// intermediate states instead of building a backlog.
+template <typename T>
+class LatestValue {
+public:
+    void publish(T value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            value_ = std::move(value);
+            version_.fetch_add(1, std::memory_order_release);
+        }
+        changed_.notify_all();
+    }
+
+    // Blocks until a value newer than `seen` exists or `running` goes false.
+    // Busy-poll mode spins on the version counter without taking the lock.
+    bool waitNewer(uint64_t& seen, T& out, bool busyPoll, const std::atomic<bool>& running) {
+        if (busyPoll) {
+            while (version_.load(std::memory_order_acquire) == seen) {
+                if (!running.load(std::memory_order_relaxed)) return false;
+                cpuRelax();
+            }
+        } else {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (version_.load(std::memory_order_acquire) == seen) {
+                if (!running.load(std::memory_order_relaxed)) return false;
+                changed_.wait_for(lock, std::chrono::milliseconds(100));
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        out = value_;
+        seen = version_.load(std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::atomic<uint64_t> version_{0};
+    T value_{};
+};
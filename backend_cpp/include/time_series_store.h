@@ -0,0 +1,381 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// MSB-first bit stream over 64-bit words
+class BitWriter {
+public:
+    void write(uint64_t value, int bits) {
+        while (bits > 0) {
+            size_t offset = bitCount_ & 63;
+            if (offset == 0) words_.push_back(0);
+            int room = 64 - static_cast<int>(offset);
+            int take = std::min(room, bits);
+            uint64_t chunk = (value >> (bits - take)) & (take == 64 ? ~uint64_t(0) : ((uint64_t(1) << take) - 1));
+            words_.back() |= chunk << (room - take);
+            bitCount_ += take;
+            bits -= take;
+        }
+    }
+
+    size_t bitCount() const { return bitCount_; }
+    const std::vector<uint64_t>& words() const { return words_; }
+    void shrink() { words_.shrink_to_fit(); }
+
+private:
+    std::vector<uint64_t> words_;
+    size_t bitCount_ = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const std::vector<uint64_t>& words, size_t bitCount) : words_(words), bitCount_(bitCount) {}
+
+    uint64_t read(int bits) {
+        uint64_t value = 0;
+        while (bits > 0) {
+            size_t offset = position_ & 63;
+            int room = 64 - static_cast<int>(offset);
+            int take = std::min(room, bits);
+            uint64_t word = words_[position_ >> 6];
+            uint64_t chunk = (word >> (room - take)) & (take == 64 ? ~uint64_t(0) : ((uint64_t(1) << take) - 1));
+            value = take == 64 ? chunk : (value << take) | chunk;
+            position_ += take;
+            bits -= take;
+        }
+        return value;
+    }
+
+    bool readBit() { return read(1) != 0; }
+    bool atEnd() const { return position_ >= bitCount_; }
+
+private:
+    const std::vector<uint64_t>& words_;
+    size_t bitCount_;
+    size_t position_ = 0;
+};
+
+struct TimePoint {
+    int64_t timestamp = 0;  // ms since epoch
+    double value = 0.0;
+};
+
+// Append-only chunk in the Gorilla format (Pelkonen et al., VLDB 2015):
+// timestamps as delta-of-delta with variable-width buckets, values as the
+// XOR against the previous value with a reusable leading/trailing-zero
+// window. Regular 1 s snapshots cost one bit per timestamp and unchanged
+// prices one bit per value.
+class GorillaChunk {
+public:
+    explicit GorillaChunk(size_t capacity) : capacity_(capacity) {}
+
+    bool full() const { return count_ >= capacity_; }
+    size_t size() const { return count_; }
+    int64_t firstTime() const { return firstTime_; }
+    int64_t lastTime() const { return lastTime_; }
+    size_t bytes() const { return bits_.words().capacity() * sizeof(uint64_t) + sizeof(*this); }
+
+    // Timestamps must be non-decreasing; out-of-order points are rejected
+    bool append(int64_t timestamp, double value) {
+        if (full() || (count_ > 0 && timestamp < lastTime_)) return false;
+
+        uint64_t valueBits;
+        std::memcpy(&valueBits, &value, sizeof(valueBits));
+
+        if (count_ == 0) {
+            bits_.write(static_cast<uint64_t>(timestamp), 64);
+            bits_.write(valueBits, 64);
+            firstTime_ = timestamp;
+        } else {
+            writeTimestamp(timestamp);
+            writeValue(valueBits);
+        }
+
+        lastDelta_ = count_ == 0 ? 0 : timestamp - lastTime_;
+        lastTime_ = timestamp;
+        lastValueBits_ = valueBits;
+        ++count_;
+        return true;
+    }
+
+    void seal() { bits_.shrink(); }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        if (count_ == 0) return;
+
+        BitReader reader(bits_.words(), bits_.bitCount());
+        int64_t timestamp = static_cast<int64_t>(reader.read(64));
+        uint64_t valueBits = reader.read(64);
+        int64_t delta = 0;
+        int leading = 0, trailing = 0;
+        emit(fn, timestamp, valueBits);
+
+        for (size_t i = 1; i < count_; ++i) {
+            delta += readDeltaOfDelta(reader);
+            timestamp += delta;
+
+            if (reader.readBit()) {
+                if (reader.readBit()) {
+                    leading = static_cast<int>(reader.read(6));
+                    int meaningful = static_cast<int>(reader.read(6)) + 1;
+                    trailing = 64 - leading - meaningful;
+                }
+                int meaningful = 64 - leading - trailing;
+                valueBits ^= reader.read(meaningful) << trailing;
+            }
+            emit(fn, timestamp, valueBits);
+        }
+    }
+
+private:
+    template <typename Fn>
+    static void emit(Fn& fn, int64_t timestamp, uint64_t valueBits) {
+        double value;
+        std::memcpy(&value, &valueBits, sizeof(value));
+        fn(TimePoint{timestamp, value});
+    }
+
+    void writeTimestamp(int64_t timestamp) {
+        int64_t delta = timestamp - lastTime_;
+        int64_t dod = delta - lastDelta_;
+        if (dod == 0) {
+            bits_.write(0, 1);
+        } else if (dod >= -63 && dod <= 64) {
+            bits_.write(0b10, 2);
+            bits_.write(static_cast<uint64_t>(dod + 63), 7);
+        } else if (dod >= -255 && dod <= 256) {
+            bits_.write(0b110, 3);
+            bits_.write(static_cast<uint64_t>(dod + 255), 9);
+        } else if (dod >= -2047 && dod <= 2048) {
+            bits_.write(0b1110, 4);
+            bits_.write(static_cast<uint64_t>(dod + 2047), 12);
+        } else {
+            bits_.write(0b1111, 4);
+            bits_.write(static_cast<uint64_t>(dod), 64);
+        }
+    }
+
+    static int64_t readDeltaOfDelta(BitReader& reader) {
+        if (!reader.readBit()) return 0;
+        if (!reader.readBit()) return static_cast<int64_t>(reader.read(7)) - 63;
+        if (!reader.readBit()) return static_cast<int64_t>(reader.read(9)) - 255;
+        if (!reader.readBit()) return static_cast<int64_t>(reader.read(12)) - 2047;
+        return static_cast<int64_t>(reader.read(64));
+    }
+
+    void writeValue(uint64_t valueBits) {
+        uint64_t x = valueBits ^ lastValueBits_;
+        if (x == 0) {
+            bits_.write(0, 1);
+            return;
+        }
+
+        int leading = std::min(countLeadingZeros(x), 63);
+        int trailing = countTrailingZeros(x);
+        if (windowValid_ && leading >= leading_ && trailing >= trailing_) {
+            // Fits the previous window: only the meaningful bits are written
+            bits_.write(0b10, 2);
+            bits_.write(x >> trailing_, 64 - leading_ - trailing_);
+            return;
+        }
+
+        int meaningful = 64 - leading - trailing;
+        bits_.write(0b11, 2);
+        bits_.write(static_cast<uint64_t>(leading), 6);
+        bits_.write(static_cast<uint64_t>(meaningful - 1), 6);
+        bits_.write(x >> trailing, meaningful);
+        leading_ = leading;
+        trailing_ = trailing;
+        windowValid_ = true;
+    }
+
+    static int countLeadingZeros(uint64_t x) {
+        int n = 0;
+        for (uint64_t bit = uint64_t(1) << 63; bit && !(x & bit); bit >>= 1) ++n;
+        return n;
+    }
+
+    static int countTrailingZeros(uint64_t x) {
+        int n = 0;
+        for (uint64_t bit = 1; bit && !(x & bit); bit <<= 1) ++n;
+        return n;
+    }
+
+    const size_t capacity_;
+    BitWriter bits_;
+    size_t count_ = 0;
+    int64_t firstTime_ = 0;
+    int64_t lastTime_ = 0;
+    int64_t lastDelta_ = 0;
+    uint64_t lastValueBits_ = 0;
+    int leading_ = 0;
+    int trailing_ = 0;
+    bool windowValid_ = false;
+};
+
+struct ResampledBar {
+    int64_t timestamp = 0;  // bucket start
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    double close = 0.0;
+    size_t count = 0;
+};
+
+// One field of one instrument: sealed chunks plus the open head chunk.
+// Sealed chunks are immutable and shared with readers, so a query copies a
+// handful of pointers under the lock and decodes outside it.
+class TimeSeries {
+public:
+    explicit TimeSeries(size_t chunkPoints) : chunkPoints_(chunkPoints), head_(std::make_shared<GorillaChunk>(chunkPoints)) {}
+
+    bool append(int64_t timestamp, double value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (head_->full()) {
+            head_->seal();
+            sealed_.push_back(head_);
+            head_ = std::make_shared<GorillaChunk>(chunkPoints_);
+        }
+        if (head_->size() == 0 && !sealed_.empty() && timestamp < sealed_.back()->lastTime()) return false;
+        return head_->append(timestamp, value);
+    }
+
+    // Drops whole sealed chunks that end before `cutoff`
+    void trimBefore(int64_t cutoff) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto keep = std::find_if(sealed_.begin(), sealed_.end(),
+                                 [cutoff](const auto& chunk) { return chunk->lastTime() >= cutoff; });
+        sealed_.erase(sealed_.begin(), keep);
+    }
+
+    std::vector<TimePoint> range(int64_t from, int64_t to) const {
+        std::vector<TimePoint> points;
+        for (const auto& chunk : chunksIn(from, to)) {
+            chunk->forEach([&](const TimePoint& point) {
+                if (point.timestamp >= from && point.timestamp <= to) points.push_back(point);
+            });
+        }
+        return points;
+    }
+
+    std::vector<ResampledBar> resample(int64_t from, int64_t to, int64_t bucketMs) const {
+        std::vector<ResampledBar> bars;
+        if (bucketMs <= 0) return bars;
+
+        for (const auto& chunk : chunksIn(from, to)) {
+            chunk->forEach([&](const TimePoint& point) {
+                if (point.timestamp < from || point.timestamp > to) return;
+
+                int64_t bucket = point.timestamp - ((point.timestamp % bucketMs) + bucketMs) % bucketMs;
+                if (bars.empty() || bars.back().timestamp != bucket) {
+                    bars.push_back({bucket, point.value, point.value, point.value, point.value, 0});
+                }
+                ResampledBar& bar = bars.back();
+                bar.high = std::max(bar.high, point.value);
+                bar.low = std::min(bar.low, point.value);
+                bar.close = point.value;
+                ++bar.count;
+            });
+        }
+        return bars;
+    }
+
+    size_t points() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t total = head_->size();
+        for (const auto& chunk : sealed_) total += chunk->size();
+        return total;
+    }
+
+    size_t bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t total = head_->bytes();
+        for (const auto& chunk : sealed_) total += chunk->bytes();
+        return total;
+    }
+
+private:
+    // The head chunk is copied, since the writer keeps appending to it
+    std::vector<std::shared_ptr<const GorillaChunk>> chunksIn(int64_t from, int64_t to) const {
+        std::vector<std::shared_ptr<const GorillaChunk>> chunks;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& chunk : sealed_) {
+            if (chunk->lastTime() >= from && chunk->firstTime() <= to) chunks.push_back(chunk);
+        }
+        if (head_->size() > 0 && head_->lastTime() >= from && head_->firstTime() <= to) {
+            chunks.push_back(std::make_shared<const GorillaChunk>(*head_));
+        }
+        return chunks;
+    }
+
+    const size_t chunkPoints_;
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<const GorillaChunk>> sealed_;
+    std::shared_ptr<GorillaChunk> head_;
+};
+
+// Session store keyed by instrument and field ("RELIANCE", "spot"). Series
+// are created on first append and never removed, so lookups take a shared
+// lock and appends to different series do not contend.
+class TimeSeriesStore {
+public:
+    TimeSeriesStore(size_t chunkPoints = 3600, int64_t retentionMs = 0)
+        : chunkPoints_(chunkPoints), retentionMs_(retentionMs) {}
+
+    void append(const std::string& instrument, const std::string& field, int64_t timestamp, double value) {
+        TimeSeries& series = getOrCreate(instrument, field);
+        series.append(timestamp, value);
+        if (retentionMs_ > 0) series.trimBefore(timestamp - retentionMs_);
+    }
+
+    std::shared_ptr<const TimeSeries> find(const std::string& instrument, const std::string& field) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = series_.find({instrument, field});
+        return it == series_.end() ? nullptr : it->second;
+    }
+
+    std::map<std::string, std::vector<std::string>> catalog() const {
+        std::map<std::string, std::vector<std::string>> fields;
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& [key, series] : series_) fields[key.first].push_back(key.second);
+        return fields;
+    }
+
+    std::pair<size_t, size_t> usage() const {
+        size_t points = 0, bytes = 0;
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& [key, series] : series_) {
+            points += series->points();
+            bytes += series->bytes();
+        }
+        return {points, bytes};
+    }
+
+private:
+    TimeSeries& getOrCreate(const std::string& instrument, const std::string& field) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = series_.find({instrument, field});
+            if (it != series_.end()) return *it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto& series = series_[{instrument, field}];
+        if (!series) series = std::make_shared<TimeSeries>(chunkPoints_);
+        return *series;
+    }
+
+    const size_t chunkPoints_;
+    const int64_t retentionMs_;
+    mutable std::shared_mutex mutex_;
+    std::map<std::pair<std::string, std::string>, std::shared_ptr<TimeSeries>> series_;
+};
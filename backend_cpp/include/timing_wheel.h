@@ -0,0 +1,296 @@
+#pragma once
+
+#include "event_queue.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Hierarchical timing wheel (Varghese & Lauck) with 4 levels of 256 slots.
+// Timers live in a pooled array threaded onto intrusive doubly-linked slot
+// lists, so schedule and cancel are O(1) and no allocation happens once the
+// pool has grown to the working set. Level 0 resolves single ticks; each
+// higher level covers 256x the span of the one below and is cascaded down
+// when the lower level wraps. Not thread-safe: see TimerScheduler.
+template <typename Payload>
+class TimingWheel {
+public:
+    using TimerId = uint64_t;
+    static constexpr TimerId kInvalidTimer = 0;
+
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 8;
+    static constexpr uint64_t kSlots = 1u << kSlotBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+    static constexpr uint64_t kMaxDelayTicks = (uint64_t(1) << (kLevels * kSlotBits)) - 1;
+
+    explicit TimingWheel(size_t reserve = 0) {
+        nodes_.reserve(reserve);
+        for (auto& level : heads_) level.fill(kNil);
+    }
+
+    uint64_t currentTick() const { return current_; }
+    size_t size() const { return active_; }
+
+    // Arms a timer `delayTicks` from now (minimum one tick). A non-zero
+    // `periodTicks` re-arms it after every expiry until cancelled.
+    TimerId schedule(uint64_t delayTicks, Payload payload, uint64_t periodTicks = 0) {
+        uint32_t index = allocate();
+        Node& node = nodes_[index];
+        node.expiry = current_ + std::clamp<uint64_t>(delayTicks, 1, kMaxDelayTicks);
+        node.period = std::min(periodTicks, kMaxDelayTicks);
+        node.payload = std::move(payload);
+        node.active = true;
+        link(index);
+        ++active_;
+        return makeId(index, node.generation);
+    }
+
+    bool cancel(TimerId id) {
+        uint32_t index = static_cast<uint32_t>(id & 0xffffffffu);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (id == kInvalidTimer || index >= nodes_.size()) return false;
+
+        Node& node = nodes_[index];
+        if (!node.active || node.generation != generation) return false;
+
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    // Moves the wheel forward to `targetTick`, calling onFire(id, payload)
+    // for each expiry in tick order. Periodic timers are re-armed before the
+    // callback runs, so the callback may cancel them.
+    template <typename OnFire>
+    void advance(uint64_t targetTick, OnFire&& onFire) {
+        while (current_ < targetTick) {
+            ++current_;
+            cascade();
+
+            uint32_t index = detach(0, current_ & kSlotMask);
+            while (index != kNil) {
+                uint32_t next = nodes_[index].next;
+                Node& node = nodes_[index];
+                TimerId id = makeId(index, node.generation);
+                if (node.period > 0) {
+                    node.expiry = current_ + node.period;
+                    link(index);
+                    onFire(id, static_cast<const Payload&>(node.payload));
+                } else {
+                    Payload payload = std::move(node.payload);
+                    release(index);
+                    onFire(id, static_cast<const Payload&>(payload));
+                }
+                index = next;
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t kNil = 0xffffffffu;
+
+    struct Node {
+        uint64_t expiry = 0;
+        uint64_t period = 0;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        uint32_t generation = 1;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool active = false;
+        Payload payload{};
+    };
+
+    static TimerId makeId(uint32_t index, uint32_t generation) {
+        return (uint64_t(generation) << 32) | index;
+    }
+
+    uint32_t allocate() {
+        if (freeHead_ != kNil) {
+            uint32_t index = freeHead_;
+            freeHead_ = nodes_[index].next;
+            return index;
+        }
+        nodes_.emplace_back();
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void release(uint32_t index) {
+        Node& node = nodes_[index];
+        node.active = false;
+        node.payload = Payload{};
+        // Generation 0 is never handed out so kInvalidTimer stays unique
+        if (++node.generation == 0) node.generation = 1;
+        node.prev = kNil;
+        node.next = freeHead_;
+        freeHead_ = index;
+        --active_;
+    }
+
+    // Picks the lowest level whose window still contains the expiry, i.e.
+    // the level at which expiry and now first share all higher-order bits.
+    void link(uint32_t index) {
+        Node& node = nodes_[index];
+        int level = 0;
+        while (level < kLevels - 1 &&
+               (node.expiry >> ((level + 1) * kSlotBits)) != (current_ >> ((level + 1) * kSlotBits))) {
+            ++level;
+        }
+        uint32_t slot = static_cast<uint32_t>((node.expiry >> (level * kSlotBits)) & kSlotMask);
+
+        node.level = static_cast<uint8_t>(level);
+        node.slot = static_cast<uint8_t>(slot);
+        node.prev = kNil;
+        node.next = heads_[level][slot];
+        if (node.next != kNil) nodes_[node.next].prev = index;
+        heads_[level][slot] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.prev != kNil) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.level][node.slot] = node.next;
+        }
+        if (node.next != kNil) nodes_[node.next].prev = node.prev;
+        node.prev = node.next = kNil;
+    }
+
+    uint32_t detach(int level, uint64_t slot) {
+        uint32_t head = heads_[level][slot];
+        heads_[level][slot] = kNil;
+        return head;
+    }
+
+    // When a level wraps to slot 0, the matching slot one level up is
+    // redistributed across the finer levels.
+    void cascade() {
+        for (int level = 1; level < kLevels; ++level) {
+            if ((current_ & ((uint64_t(1) << (level * kSlotBits)) - 1)) != 0) break;
+
+            uint32_t index = detach(level, (current_ >> (level * kSlotBits)) & kSlotMask);
+            while (index != kNil) {
+                uint32_t next = nodes_[index].next;
+                link(index);
+                index = next;
+            }
+        }
+    }
+
+    std::vector<Node> nodes_;
+    std::array<std::array<uint32_t, kSlots>, kLevels> heads_{};
+    uint32_t freeHead_ = kNil;
+    uint64_t current_ = 0;
+    size_t active_ = 0;
+};
+
+// Runs a TimingWheel on its own thread and posts each fired payload into the
+// engine's EventQueue, so timer work is executed by the dispatcher rather than
+// on the wheel thread. schedule/cancel are safe to call from any thread.
+template <typename Payload>
+class TimerScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = typename TimingWheel<Payload>::TimerId;
+
+    TimerScheduler(EventQueue<Payload>& sink, std::chrono::milliseconds tick = std::chrono::milliseconds(10),
+                   size_t reserve = 1024)
+        : sink_(sink), tick_(std::max(tick, std::chrono::milliseconds(1))), wheel_(reserve), epoch_(Clock::now()) {}
+
+    ~TimerScheduler() { stop(); }
+
+    TimerScheduler(const TimerScheduler&) = delete;
+    TimerScheduler& operator=(const TimerScheduler&) = delete;
+
+    void start() {
+        bool expected = false;
+        if (!running_.compare_exchange_strong(expected, true)) return;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return;
+            running_ = false;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    TimerId scheduleAfter(std::chrono::milliseconds delay, Payload payload,
+                          std::chrono::milliseconds period = std::chrono::milliseconds(0)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // The expiry tick is the first one at or after the deadline, measured
+        // from the clock rather than the wheel's last tick, so a timer never
+        // fires early and fires at most one tick late
+        uint64_t expiry = ticksCeil(Clock::now() - epoch_ + std::max(delay, std::chrono::milliseconds(0)));
+        uint64_t current = wheel_.currentTick();
+        return wheel_.schedule(expiry > current ? expiry - current : 1, std::move(payload), ticksCeil(period));
+    }
+
+    TimerId scheduleAt(std::chrono::system_clock::time_point when, Payload payload,
+                       std::chrono::milliseconds period = std::chrono::milliseconds(0)) {
+        auto delay = std::chrono::ceil<std::chrono::milliseconds>(when - std::chrono::system_clock::now());
+        return scheduleAfter(std::max(delay, std::chrono::milliseconds(0)), std::move(payload), period);
+    }
+
+    bool cancel(TimerId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return wheel_.cancel(id);
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return wheel_.size();
+    }
+
+private:
+    uint64_t ticksSinceEpoch(Clock::time_point now) const {
+        return static_cast<uint64_t>((now - epoch_) / tick_);
+    }
+
+    uint64_t ticksCeil(Clock::duration duration) const {
+        if (duration.count() <= 0) return 0;
+        Clock::duration tick = tick_;
+        return static_cast<uint64_t>((duration + tick - Clock::duration(1)) / tick);
+    }
+
+    void run() {
+        std::vector<Payload> fired;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            Clock::time_point nextTick = epoch_ + tick_ * (wheel_.currentTick() + 1);
+            wake_.wait_until(lock, nextTick, [this] { return !running_; });
+            if (!running_) break;
+
+            wheel_.advance(ticksSinceEpoch(Clock::now()),
+                           [&fired](TimerId, const Payload& payload) { fired.push_back(payload); });
+
+            if (!fired.empty()) {
+                lock.unlock();
+                sink_.pushAll(fired);
+                lock.lock();
+            }
+        }
+    }
+
+    EventQueue<Payload>& sink_;
+    const std::chrono::milliseconds tick_;
+    TimingWheel<Payload> wheel_;
+    const Clock::time_point epoch_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
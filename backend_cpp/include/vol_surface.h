@@ -0,0 +1,569 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Raw SVI total-variance smile for one expiry (Gatheral 2004):
+//   w(k) = a + b * (rho * (k - m) + sqrt((k - m)^2 + sigma^2)),  k = ln(K / F)
+struct SviParams {
+    double a = 0.0;
+    double b = 0.0;
+    double rho = 0.0;
+    double m = 0.0;
+    double sigma = 0.1;
+
+    double totalVariance(double k) const {
+        double x = k - m;
+        return a + b * (rho * x + std::sqrt(x * x + sigma * sigma));
+    }
+
+    double firstDerivative(double k) const {
+        double x = k - m;
+        return b * (rho + x / std::sqrt(x * x + sigma * sigma));
+    }
+
+    double secondDerivative(double k) const {
+        double x = k - m;
+        double r = std::sqrt(x * x + sigma * sigma);
+        return b * sigma * sigma / (r * r * r);
+    }
+};
+
+struct SmileQuote {
+    double strike = 0.0;
+    double impliedVol = 0.0;
+};
+
+struct SviFitResult {
+    SviParams params;
+    bool valid = false;          // false when no usable quote was left to fit
+    double rmse = 0.0;           // in total variance
+    bool butterflyFree = true;
+    bool withinLeeBounds = true;
+};
+
+// Fits one slice with the quasi-explicit method (Zeliade 2009): for fixed
+// (m, sigma) the remaining parameters enter linearly, so each objective
+// evaluation is a 3x3 least-squares solve and the outer search is 2-D.
+class SviCalibrator {
+public:
+    static SviFitResult fit(const std::vector<SmileQuote>& quotes, double forward, double T) {
+        std::vector<double> ks;
+        std::vector<double> ws;
+        ks.reserve(quotes.size());
+        ws.reserve(quotes.size());
+        for (const auto& quote : quotes) {
+            if (quote.strike <= 0.0 || quote.impliedVol <= 0.0) continue;
+            ks.push_back(std::log(quote.strike / forward));
+            ws.push_back(quote.impliedVol * quote.impliedVol * T);
+        }
+
+        SviFitResult result;
+        if (ks.empty()) return result;
+        result.valid = true;
+
+        // Too few points for five parameters: flat smile at the mean variance
+        if (ks.size() < 5) {
+            double mean = 0.0;
+            for (double w : ws) mean += w;
+            result.params.a = mean / ws.size();
+            result.params.b = 0.0;
+            result.rmse = rmse(result.params, ks, ws);
+            return result;
+        }
+
+        size_t atm = std::min_element(ws.begin(), ws.end()) - ws.begin();
+        double wMax = *std::max_element(ws.begin(), ws.end());
+
+        // Nelder-Mead over (m, log sigma)
+        auto objective = [&](const std::array<double, 2>& x, SviParams* out) {
+            SviParams params = solveLinear(ks, ws, x[0], std::exp(x[1]), wMax);
+            if (out) *out = params;
+            double sse = 0.0;
+            for (size_t i = 0; i < ks.size(); ++i) {
+                double d = params.totalVariance(ks[i]) - ws[i];
+                sse += d * d;
+            }
+            return sse;
+        };
+
+        std::array<std::array<double, 2>, 3> simplex = {{
+            {ks[atm], std::log(0.1)},
+            {ks[atm] + 0.1, std::log(0.1)},
+            {ks[atm], std::log(0.3)}
+        }};
+        std::array<double, 3> values;
+        for (int i = 0; i < 3; ++i) values[i] = objective(simplex[i], nullptr);
+
+        for (int iteration = 0; iteration < 200; ++iteration) {
+            std::array<int, 3> order = {0, 1, 2};
+            std::sort(order.begin(), order.end(), [&](int l, int r) { return values[l] < values[r]; });
+            int best = order[0], mid = order[1], worst = order[2];
+            if (values[worst] - values[best] < 1e-14) break;
+
+            std::array<double, 2> centroid = {
+                0.5 * (simplex[best][0] + simplex[mid][0]),
+                0.5 * (simplex[best][1] + simplex[mid][1])
+            };
+            auto along = [&](double t) {
+                return std::array<double, 2>{
+                    centroid[0] + t * (simplex[worst][0] - centroid[0]),
+                    centroid[1] + t * (simplex[worst][1] - centroid[1])
+                };
+            };
+
+            auto reflected = along(-1.0);
+            double fr = objective(reflected, nullptr);
+            if (fr < values[best]) {
+                auto expanded = along(-2.0);
+                double fe = objective(expanded, nullptr);
+                if (fe < fr) {
+                    simplex[worst] = expanded;
+                    values[worst] = fe;
+                } else {
+                    simplex[worst] = reflected;
+                    values[worst] = fr;
+                }
+            } else if (fr < values[mid]) {
+                simplex[worst] = reflected;
+                values[worst] = fr;
+            } else {
+                auto contracted = along(0.5);
+                double fc = objective(contracted, nullptr);
+                if (fc < values[worst]) {
+                    simplex[worst] = contracted;
+                    values[worst] = fc;
+                } else {
+                    for (int i : {mid, worst}) {
+                        simplex[i][0] = 0.5 * (simplex[i][0] + simplex[best][0]);
+                        simplex[i][1] = 0.5 * (simplex[i][1] + simplex[best][1]);
+                        values[i] = objective(simplex[i], nullptr);
+                    }
+                }
+            }
+        }
+
+        int best = static_cast<int>(std::min_element(values.begin(), values.end()) - values.begin());
+        objective(simplex[best], &result.params);
+        result.rmse = rmse(result.params, ks, ws);
+        result.withinLeeBounds = result.params.b * (1.0 + std::abs(result.params.rho)) <= 2.0 + 1e-9;
+        result.butterflyFree = isButterflyFree(result.params);
+        return result;
+    }
+
+    // Durrleman's condition g(k) >= 0 on a log-moneyness grid
+    static bool isButterflyFree(const SviParams& p, double kMin = -1.5, double kMax = 1.5, int points = 61) {
+        for (int i = 0; i < points; ++i) {
+            double k = kMin + (kMax - kMin) * i / (points - 1);
+            double w = p.totalVariance(k);
+            if (w <= 0.0) return false;
+            double w1 = p.firstDerivative(k);
+            double w2 = p.secondDerivative(k);
+            double g = std::pow(1.0 - k * w1 / (2.0 * w), 2) - 0.25 * w1 * w1 * (1.0 / w + 0.25) + 0.5 * w2;
+            if (g < -1e-9) return false;
+        }
+        return true;
+    }
+
+private:
+    static double rmse(const SviParams& p, const std::vector<double>& ks, const std::vector<double>& ws) {
+        double sse = 0.0;
+        for (size_t i = 0; i < ks.size(); ++i) {
+            double d = p.totalVariance(ks[i]) - ws[i];
+            sse += d * d;
+        }
+        return std::sqrt(sse / ks.size());
+    }
+
+    // With y = (k - m) / s, w = a + d*y + c*sqrt(y^2 + 1) is linear in
+    // (a, d, c). The unconstrained solution is projected onto the domain
+    // 0 <= c, |d| <= c, c + |d| <= 2s (Lee wings), 0 <= a <= max(w).
+    static SviParams solveLinear(const std::vector<double>& ks, const std::vector<double>& ws,
+                                 double m, double s, double wMax) {
+        double sy = 0, sz = 0, syy = 0, szz = 0, syz = 0, sw = 0, syw = 0, szw = 0;
+        double n = static_cast<double>(ks.size());
+        for (size_t i = 0; i < ks.size(); ++i) {
+            double y = (ks[i] - m) / s;
+            double z = std::sqrt(y * y + 1.0);
+            sy += y; sz += z; syy += y * y; szz += z * z; syz += y * z;
+            sw += ws[i]; syw += y * ws[i]; szw += z * ws[i];
+        }
+
+        // Normal equations for [a, d, c], solved by Cramer's rule
+        double m00 = n, m01 = sy, m02 = sz;
+        double m11 = syy, m12 = syz, m22 = szz;
+        double det = m00 * (m11 * m22 - m12 * m12) - m01 * (m01 * m22 - m12 * m02) + m02 * (m01 * m12 - m11 * m02);
+
+        double a = sw / n, d = 0.0, c = 0.0;
+        if (std::abs(det) > 1e-18) {
+            a = (sw * (m11 * m22 - m12 * m12) - m01 * (syw * m22 - m12 * szw) + m02 * (syw * m12 - m11 * szw)) / det;
+            d = (m00 * (syw * m22 - m12 * szw) - sw * (m01 * m22 - m12 * m02) + m02 * (m01 * szw - syw * m02)) / det;
+            c = (m00 * (m11 * szw - syw * m12) - m01 * (m01 * szw - syw * m02) + sw * (m01 * m12 - m11 * m02)) / det;
+        }
+
+        bool clamped = false;
+        double cMax = 2.0 * s;
+        if (c < 0.0) { c = 0.0; clamped = true; }
+        if (c > cMax) { c = cMax; clamped = true; }
+        double dMax = std::min(c, cMax - c);
+        if (std::abs(d) > dMax) { d = std::copysign(dMax, d); clamped = true; }
+        if (clamped) {
+            // Refit the level given the projected shape
+            double residual = 0.0;
+            for (size_t i = 0; i < ks.size(); ++i) {
+                double y = (ks[i] - m) / s;
+                residual += ws[i] - d * y - c * std::sqrt(y * y + 1.0);
+            }
+            a = residual / n;
+        }
+        a = std::clamp(a, 0.0, wMax);
+
+        SviParams params;
+        params.a = a;
+        params.b = c / s;
+        params.rho = c > 0.0 ? d / c : 0.0;
+        params.m = m;
+        params.sigma = s;
+        return params;
+    }
+};
+
+// Year fraction convention used for every T on the surface
+constexpr double kVolYearMs = 365.0 * 24 * 3600 * 1000;
+
+inline int64_t volSurfaceNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Fitted slice as stored in a surface snapshot
+struct VolSlice {
+    int64_t expiry = 0;         // ms since epoch
+    double T = 0.0;             // years to expiry when the snapshot was published
+    double fitT = 0.0;          // years to expiry when the slice was fit
+    double forward = 0.0;       // forward the slice was fit at; k = ln(K / forward)
+    SviParams params;
+    double rmse = 0.0;
+    bool butterflyFree = true;
+    bool withinLeeBounds = true;
+    bool calendarFree = true;   // w(k) not below the previous expiry's
+};
+
+// Immutable calibrated surface. Slices are anchored to their expiry dates:
+// time to expiry is taken from the clock at lookup, and each slice keeps the
+// implied vol it was fit at as it ages, so a surface published yesterday
+// still lines up with today's queries. Lookups interpolate total variance
+// linearly in T at fixed strike, each slice reading its own log-moneyness
+// against the forward it was fit at, and extrapolate at constant vol beyond
+// the first and last live expiries. Parameters are stored column-wise so the
+// batch lookup streams through contiguous arrays.
+class VolSurfaceSnapshot {
+public:
+    VolSurfaceSnapshot(double spot, double rate, int64_t asOfMs, const std::vector<VolSlice>& slices)
+        : spot_(spot), rate_(rate), asOfMs_(asOfMs), slices_(slices) {
+        for (const auto& slice : slices_) {
+            T_.push_back(slice.T);
+            varianceScale_.push_back(1.0 / slice.fitT);
+            logF_.push_back(std::log(slice.forward));
+            a_.push_back(slice.params.a);
+            b_.push_back(slice.params.b);
+            rho_.push_back(slice.params.rho);
+            m_.push_back(slice.params.m);
+            sigma_.push_back(slice.params.sigma);
+        }
+    }
+
+    double spot() const { return spot_; }
+    double rate() const { return rate_; }
+    int64_t asOf() const { return asOfMs_; }
+    const std::vector<VolSlice>& slices() const { return slices_; }
+
+    double volatility(double strike, double T, int64_t nowMs = volSurfaceNowMs()) const {
+        double out = 0.0;
+        volatilities(&strike, &T, 1, &out, nowMs);
+        return out;
+    }
+
+    // sigma(K_i, T_i) for i in [0, n), T_i in years from `nowMs`. False (and
+    // `out` untouched) once every expiry on the surface has passed.
+    bool volatilities(const double* strikes, const double* times, size_t n, double* out,
+                      int64_t nowMs = volSurfaceNowMs()) const {
+        // All slices age equally, so queries are shifted onto the publish-time
+        // grid instead of rebuilding it
+        const double elapsed = static_cast<double>(nowMs - asOfMs_) / kVolYearMs;
+        const size_t count = T_.size();
+        const size_t first = std::upper_bound(T_.begin(), T_.end(), elapsed) - T_.begin();
+        if (first == count) return false;
+
+        for (size_t i = 0; i < n; ++i) {
+            double T = std::max(times[i], 1e-6);
+            double logK = std::log(strikes[i]);
+
+            size_t hi = std::lower_bound(T_.begin() + first, T_.end(), T + elapsed) - T_.begin();
+            double w;
+            if (hi == first) {
+                w = fitVariance(first, logK) * T;
+            } else if (hi == count) {
+                w = fitVariance(count - 1, logK) * T;
+            } else {
+                size_t lo = hi - 1;
+                double t = (T + elapsed - T_[lo]) / (T_[hi] - T_[lo]);
+                w = (1.0 - t) * fitVariance(lo, logK) * (T_[lo] - elapsed) +
+                    t * fitVariance(hi, logK) * (T_[hi] - elapsed);
+            }
+            out[i] = std::sqrt(std::max(w, 0.0) / T);
+        }
+        return true;
+    }
+
+private:
+    // Implied variance per year of slice j at log-strike logK, as fit
+    double fitVariance(size_t j, double logK) const {
+        double x = logK - logF_[j] - m_[j];
+        return (a_[j] + b_[j] * (rho_[j] * x + std::sqrt(x * x + sigma_[j] * sigma_[j]))) * varianceScale_[j];
+    }
+
+    double spot_;
+    double rate_;
+    int64_t asOfMs_;
+    std::vector<VolSlice> slices_;
+    std::vector<double> T_, varianceScale_, logF_, a_, b_, rho_, m_, sigma_;
+};
+
+// Per-underlying surface with incremental recalibration. Slices are keyed by
+// expiry (ms since epoch) and quotes are kept in strike space; only slices
+// whose quotes moved beyond the tolerance are refit, and dirty slices are
+// calibrated in parallel. A fitted slice keeps the forward and vol it was fit
+// at, so neither a spot move nor the passage of time refits anything.
+// Expired slices are dropped. Readers take a shared snapshot.
+class VolSurface {
+public:
+    explicit VolSurface(double quoteTolerance = 1e-4) : quoteTolerance_(quoteTolerance) {}
+
+    // Replaces the quotes for one expiry; returns true if the slice is dirty
+    bool updateSlice(int64_t expiry, std::vector<SmileQuote> quotes) {
+        std::sort(quotes.begin(), quotes.end(),
+                  [](const SmileQuote& l, const SmileQuote& r) { return l.strike < r.strike; });
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slice = slices_[expiry];
+        if (!slice.fitted || !sameQuotes(slice.quotes, quotes)) {
+            slice.quotes = std::move(quotes);
+            markDirty(slice);
+        }
+        return slice.dirty;
+    }
+
+    // Drops every expiry not in `expiries` (a full chain was posted); the
+    // next recalibrate publishes without them. Returns slices removed.
+    size_t retainExpiries(const std::vector<int64_t>& expiries) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t removed = 0;
+        for (auto it = slices_.begin(); it != slices_.end();) {
+            if (std::find(expiries.begin(), expiries.end(), it->first) == expiries.end()) {
+                it = slices_.erase(it);
+                ++removed;
+            } else {
+                ++it;
+            }
+        }
+        changed_ = changed_ || removed > 0;
+        return removed;
+    }
+
+    // Forward inputs for slices refit from now on; fitted slices are untouched
+    void setMarket(double spot, double rate) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        spot_ = spot;
+        rate_ = rate;
+    }
+
+    // Drops expired slices, refits dirty ones and publishes a new snapshot
+    // when anything changed; returns slices refit
+    size_t recalibrate(int64_t nowMs = volSurfaceNowMs(), bool parallel = true) {
+        std::vector<int64_t> dirty;
+        std::vector<std::vector<SmileQuote>> quotes;
+        std::vector<uint64_t> versions;
+        double spot, rate;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = slices_.begin(); it != slices_.end() && it->first <= nowMs;) {
+                it = slices_.erase(it);
+                changed_ = true;
+            }
+            for (auto& [expiry, slice] : slices_) {
+                if (!slice.dirty) continue;
+                dirty.push_back(expiry);
+                quotes.push_back(slice.quotes);
+                versions.push_back(slice.version);
+            }
+            spot = spot_;
+            rate = rate_;
+            if (dirty.empty()) {
+                if (changed_) publish(spot_, rate_, nowMs);
+                return 0;
+            }
+        }
+
+        std::vector<SviFitResult> fits(dirty.size());
+        std::vector<double> forwards(dirty.size());
+        std::vector<double> times(dirty.size());
+
+        int count = static_cast<int>(dirty.size());
+        (void)parallel;  // only read by the OpenMP clause
+        #pragma omp parallel for schedule(dynamic) if(parallel)
+        for (int i = 0; i < count; ++i) {
+            times[i] = static_cast<double>(dirty[i] - nowMs) / kVolYearMs;
+            forwards[i] = spot * std::exp(rate * times[i]);
+            fits[i] = SviCalibrator::fit(quotes[i], forwards[i], times[i]);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t installed = 0;
+        for (size_t i = 0; i < dirty.size(); ++i) {
+            // Quotes that arrived mid-calibration keep the slice dirty, a
+            // concurrent run on newer quotes may already have installed its
+            // fit, and the expiry may have been dropped; in each case this
+            // result is stale and is discarded
+            auto it = slices_.find(dirty[i]);
+            if (it == slices_.end() || it->second.version != versions[i]) continue;
+            // A slice with nothing to fit is withdrawn rather than published flat at zero
+            Slice& slice = it->second;
+            slice.fit = fits[i];
+            slice.forward = forwards[i];
+            slice.fitT = times[i];
+            slice.fitted = fits[i].valid;
+            slice.dirty = false;
+            ++installed;
+        }
+        publish(spot_, rate_, nowMs);
+        return installed;
+    }
+
+    std::shared_ptr<const VolSurfaceSnapshot> snapshot() const {
+        std::lock_guard<std::mutex> lock(snapshotMutex_);
+        return snapshot_;
+    }
+
+private:
+    struct Slice {
+        std::vector<SmileQuote> quotes;
+        SviFitResult fit;
+        double forward = 0.0;
+        double fitT = 0.0;
+        bool fitted = false;
+        bool dirty = true;
+        uint64_t version = 0;
+    };
+
+    // Versions are surface-wide, so a slice dropped and re-added under the
+    // same expiry never matches a fit taken from its predecessor
+    void markDirty(Slice& slice) {
+        slice.dirty = true;
+        slice.version = ++nextVersion_;
+    }
+
+    bool sameQuotes(const std::vector<SmileQuote>& l, const std::vector<SmileQuote>& r) const {
+        if (l.size() != r.size()) return false;
+        for (size_t i = 0; i < l.size(); ++i) {
+            if (l[i].strike != r[i].strike) return false;
+            if (std::abs(l[i].impliedVol - r[i].impliedVol) > quoteTolerance_) return false;
+        }
+        return true;
+    }
+
+    // Caller holds mutex_
+    void publish(double spot, double rate, int64_t nowMs) {
+        changed_ = false;
+        std::vector<VolSlice> slices;
+        for (const auto& [expiry, slice] : slices_) {
+            if (!slice.fitted) continue;
+            VolSlice out;
+            out.expiry = expiry;
+            out.T = static_cast<double>(expiry - nowMs) / kVolYearMs;
+            out.fitT = slice.fitT;
+            out.forward = slice.forward;
+            out.params = slice.fit.params;
+            out.rmse = slice.fit.rmse;
+            out.butterflyFree = slice.fit.butterflyFree;
+            out.withinLeeBounds = slice.fit.withinLeeBounds;
+            if (!slices.empty()) {
+                // Compared at equal strikes and at today's time to expiry,
+                // since each slice has its own forward and fit date
+                const VolSlice& previous = slices.back();
+                double shift = std::log(out.forward / previous.forward);
+                double scale = out.T / out.fitT;
+                double previousScale = previous.T / previous.fitT;
+                for (int i = 0; i <= 30; ++i) {
+                    double k = -1.5 + 0.1 * i;
+                    if (out.params.totalVariance(k) * scale <
+                        previous.params.totalVariance(k + shift) * previousScale - 1e-9) {
+                        out.calendarFree = false;
+                        break;
+                    }
+                }
+            }
+            slices.push_back(out);
+        }
+
+        auto next = slices.empty() ? nullptr : std::make_shared<const VolSurfaceSnapshot>(spot, rate, nowMs, slices);
+        std::lock_guard<std::mutex> lock(snapshotMutex_);
+        snapshot_ = std::move(next);
+    }
+
+    const double quoteTolerance_;
+    std::mutex mutex_;
+    std::map<int64_t, Slice> slices_;
+    uint64_t nextVersion_ = 0;
+    bool changed_ = false;      // slices removed since the last publish
+    double spot_ = 0.0;
+    double rate_ = 0.0;
+
+    mutable std::mutex snapshotMutex_;
+    std::shared_ptr<const VolSurfaceSnapshot> snapshot_;
+};
+
+// Surfaces keyed by underlying, with a flat fallback for names not yet fitted
+class VolSurfaceService {
+public:
+    explicit VolSurfaceService(double defaultVolatility) : defaultVolatility_(defaultVolatility) {}
+
+    VolSurface& surface(const std::string& underlying) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& surface = surfaces_[underlying];
+        if (!surface) surface = std::make_unique<VolSurface>();
+        return *surface;
+    }
+
+    std::shared_ptr<const VolSurfaceSnapshot> snapshot(const std::string& underlying) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = surfaces_.find(underlying);
+        return it == surfaces_.end() ? nullptr : it->second->snapshot();
+    }
+
+    void volatilities(const std::string& underlying, const double* strikes, const double* times,
+                      size_t n, double* out) const {
+        // Flat default until a surface is fitted, and once all its expiries have passed
+        auto surface = snapshot(underlying);
+        if (!surface || !surface->volatilities(strikes, times, n, out)) {
+            std::fill(out, out + n, defaultVolatility_);
+        }
+    }
+
+    double defaultVolatility() const { return defaultVolatility_; }
+
+private:
+    const double defaultVolatility_;
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<VolSurface>> surfaces_;
+};
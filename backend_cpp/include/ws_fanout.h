@@ -0,0 +1,335 @@
+#pragma once
+
+#include "event_queue.h"
+#include "thread_topology.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class SlowConsumerAction {
+    Drop,       // close the connection
+    Downgrade   // keep it, but only deliver every Nth cycle
+};
+
+struct FanoutPolicy {
+    size_t maxConnections = 1000;
+    size_t maxQueuedInstruments = 4096;  // distinct instruments held per client
+    size_t maxQueuedControl = 64;        // alerts etc. that are never conflated
+    int lagCyclesBeforeAction = 5;
+    SlowConsumerAction action = SlowConsumerAction::Downgrade;
+    int downgradeInterval = 5;
+    size_t slowConsumerBytes = 256 * 1024;       // unsent bytes that count as lagging
+    size_t maxBufferedBytes = 4 * 1024 * 1024;   // no new writes above this many unsent bytes
+    int senderThreads = 2;
+};
+
+using SharedPayload = std::shared_ptr<const std::string>;
+using InstrumentUpdate = std::pair<std::string, SharedPayload>;
+
+// Bounded outbound queue for one client. Market updates are conflated by
+// instrument: a second update for a ticker that has not been sent yet
+// replaces the first in place, so a lagging client catches up to the latest
+// state instead of replaying a backlog.
+class ClientChannel {
+public:
+    ClientChannel(size_t maxInstruments, size_t maxControl)
+        : maxInstruments_(maxInstruments), maxControl_(maxControl) {}
+
+    // New instruments beyond the limit are dropped until the next flush
+    void offer(const std::string& instrument, SharedPayload payload) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto slot = slots_.find(instrument);
+        if (slot != slots_.end()) {
+            pending_[slot->second].second = std::move(payload);
+        } else if (pending_.size() < maxInstruments_) {
+            slots_.emplace(instrument, pending_.size());
+            pending_.emplace_back(instrument, std::move(payload));
+        }
+    }
+
+    void offerControl(SharedPayload payload) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (control_.size() >= maxControl_) control_.pop_front();
+        control_.push_back(std::move(payload));
+    }
+
+    // Hands the pending updates to the sender in first-enqueued order
+    void take(std::vector<SharedPayload>& control, std::vector<SharedPayload>& updates) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& payload : control_) control.push_back(std::move(payload));
+        for (auto& [instrument, payload] : pending_) updates.push_back(std::move(payload));
+        control_.clear();
+        pending_.clear();
+        slots_.clear();
+    }
+
+    bool hasPending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !pending_.empty() || !control_.empty();
+    }
+
+private:
+    const size_t maxInstruments_;
+    const size_t maxControl_;
+    mutable std::mutex mutex_;
+    std::vector<InstrumentUpdate> pending_;
+    std::unordered_map<std::string, size_t> slots_;
+    std::deque<SharedPayload> control_;
+};
+
+// Connection::buffered_amount() is added to Crow by
+// cmake/patch_crow_websocket.cmake. It is detected rather than required, so
+// the server still builds against a Crow release the patch does not match.
+template <typename Connection, typename = void>
+struct HasBufferedAmount : std::false_type {};
+
+template <typename Connection>
+struct HasBufferedAmount<Connection, std::void_t<decltype(std::declval<const Connection&>().buffered_amount())>>
+    : std::true_type {};
+
+// Fans market updates out to WebSocket clients. The broadcast thread only
+// enqueues into per-client channels; a small pool of sender threads hands the
+// frames to the connections. Crow's send_text does not block, it appends to
+// the connection's write buffer, so a client's backlog is read from
+// Connection::buffered_amount() (bytes the socket has not accepted yet).
+// Above maxBufferedBytes nothing more is written and updates keep conflating
+// in the channel; clients that stay behind for too many cycles are dropped
+// or downgraded per FanoutPolicy. Without buffered_amount() only backlog
+// in the channels themselves counts as lag and the byte cap is not enforced.
+template <typename Connection>
+class WsFanout {
+public:
+    using FrameBuilder = std::function<std::string(const std::vector<SharedPayload>& updates)>;
+
+    static constexpr bool kTracksBufferedBytes = HasBufferedAmount<Connection>::value;
+
+    WsFanout(FanoutPolicy policy, FrameBuilder buildFrame)
+        : policy_(std::move(policy)), buildFrame_(std::move(buildFrame)) {}
+
+    ~WsFanout() { stop(); }
+
+    WsFanout(const WsFanout&) = delete;
+    WsFanout& operator=(const WsFanout&) = delete;
+
+    void start(const ThreadRoleConfig& role) {
+        for (int i = 0; i < std::max(1, policy_.senderThreads); ++i) {
+            senders_.emplace_back([this, role, i] {
+                applyThreadRole("sender-" + std::to_string(i), role);
+                runSender();
+            });
+        }
+    }
+
+    void stop() {
+        ready_.close();
+        for (auto& sender : senders_) {
+            if (sender.joinable()) sender.join();
+        }
+        senders_.clear();
+    }
+
+    // Registers a client; false when max_connections is already reached
+    bool add(Connection* conn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (clients_.size() >= policy_.maxConnections) return false;
+        clients_[conn] = std::make_shared<Client>(conn, policy_);
+        return true;
+    }
+
+    // Waits out any in-flight send, so `conn` may be destroyed afterwards
+    void remove(Connection* conn) {
+        std::shared_ptr<Client> client;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = clients_.find(conn);
+            if (it == clients_.end()) return;
+            client = it->second;
+            clients_.erase(it);
+        }
+        std::lock_guard<std::mutex> sendLock(client->sendMutex);
+        client->closed = true;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return clients_.size();
+    }
+
+    bool full() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return clients_.size() >= policy_.maxConnections;
+    }
+
+    // Runs `fn(conn)` if the client is still open, serialized with its sends
+    template <typename Fn>
+    bool withConnection(Connection* conn, Fn&& fn) {
+        std::shared_ptr<Client> client = find(conn);
+        if (!client) return false;
+
+        std::lock_guard<std::mutex> sendLock(client->sendMutex);
+        if (client->closed) return false;
+        fn(*client->conn);
+        return true;
+    }
+
+    // Called once per market cycle by the broadcast thread
+    void publish(const std::vector<InstrumentUpdate>& updates) {
+        uint64_t cycle = ++cycle_;
+        for (auto& client : snapshot()) {
+            if (client->closing) continue;
+
+            // Data still in the channel or unsent in the connection's buffer
+            // means the client did not take last cycle's frame
+            if (client->channel.hasPending() || client->bufferedBytes > policy_.slowConsumerBytes) {
+                onLag(*client);
+            } else if (client->lagCycles > 0) {
+                --client->lagCycles;
+            } else if (client->downgraded) {
+                client->downgraded = false;
+            }
+
+            if (!client->downgraded || cycle % std::max(1, policy_.downgradeInterval) == 0) {
+                for (const auto& [instrument, payload] : updates) {
+                    client->channel.offer(instrument, payload);
+                }
+            }
+            // Scheduled even when nothing was offered, so the buffered byte
+            // count is refreshed every cycle
+            schedule(client);
+        }
+    }
+
+    // Delivers a non-conflated message (alerts) to every client
+    void broadcastControl(SharedPayload message) {
+        for (auto& client : snapshot()) {
+            client->channel.offerControl(message);
+            schedule(client);
+        }
+    }
+
+private:
+    struct Client {
+        Client(Connection* c, const FanoutPolicy& policy)
+            : conn(c), channel(policy.maxQueuedInstruments, policy.maxQueuedControl) {}
+
+        Connection* conn;
+        ClientChannel channel;
+        std::atomic<bool> scheduled{false};
+        std::atomic<int> lagCycles{0};
+        std::atomic<bool> downgraded{false};
+        std::atomic<bool> closing{false};
+        std::atomic<size_t> bufferedBytes{0};  // last sampled Connection::buffered_amount()
+
+        std::mutex sendMutex;  // held across a send; remove() takes it to fence
+        bool closed = false;
+    };
+
+    std::shared_ptr<Client> find(Connection* conn) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = clients_.find(conn);
+        return it == clients_.end() ? nullptr : it->second;
+    }
+
+    std::vector<std::shared_ptr<Client>> snapshot() const {
+        std::vector<std::shared_ptr<Client>> clients;
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients.reserve(clients_.size());
+        for (const auto& [conn, client] : clients_) clients.push_back(client);
+        return clients;
+    }
+
+    void schedule(const std::shared_ptr<Client>& client) {
+        if (!client->scheduled.exchange(true)) ready_.push(client);
+    }
+
+    void onLag(Client& client) {
+        if (++client.lagCycles < policy_.lagCyclesBeforeAction) return;
+
+        if (policy_.action == SlowConsumerAction::Drop) {
+            if (client.closing.exchange(true)) return;
+            std::cerr << "Dropping slow WebSocket client after " << client.lagCycles << " lagging cycles" << std::endl;
+            // Close from a sender so a blocked socket cannot stall the broadcast thread
+            client.channel.offerControl(nullptr);
+        } else if (!client.downgraded.exchange(true)) {
+            std::cerr << "Downgrading slow WebSocket client to every " << policy_.downgradeInterval
+                      << " cycles" << std::endl;
+        }
+        client.lagCycles = policy_.lagCyclesBeforeAction;
+    }
+
+    void runSender() {
+        std::vector<std::shared_ptr<Client>> batch;
+        std::vector<SharedPayload> control;
+        std::vector<SharedPayload> updates;
+
+        while (!ready_.closed()) {
+            // One client at a time, so a blocked write never holds up a
+            // batch of healthy clients queued behind it
+            if (!ready_.drain(batch, std::chrono::milliseconds(100), 1)) continue;
+
+            for (auto& client : batch) {
+                bool flushed = flush(*client, control, updates);
+                control.clear();
+                updates.clear();
+
+                // Stay scheduled until the write returns so a second sender
+                // never works on the same client. A client over its buffer cap
+                // waits for the next publish instead of being retried here.
+                client->scheduled = false;
+                if (flushed && client->channel.hasPending()) schedule(client);
+            }
+            batch.clear();
+        }
+    }
+
+    // False when the client is over maxBufferedBytes and its updates were left queued
+    bool flush(Client& client, std::vector<SharedPayload>& control, std::vector<SharedPayload>& updates) {
+        std::lock_guard<std::mutex> sendLock(client.sendMutex);
+        if constexpr (kTracksBufferedBytes) {
+            if (!client.closed && !client.closing) {
+                size_t buffered = client.conn->buffered_amount();
+                client.bufferedBytes = buffered;
+                if (buffered >= policy_.maxBufferedBytes) return false;
+            }
+        }
+
+        client.channel.take(control, updates);
+        if (client.closed) return true;
+
+        for (const auto& message : control) {
+            if (!message) {
+                // Close marker queued by the drop policy
+                client.conn->close("Slow consumer");
+                client.closed = true;
+                return true;
+            }
+            client.conn->send_text(*message);
+        }
+        if (!updates.empty()) {
+            client.conn->send_text(buildFrame_(updates));
+        }
+        return true;
+    }
+
+    const FanoutPolicy policy_;
+    const FrameBuilder buildFrame_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<Connection*, std::shared_ptr<Client>> clients_;
+    std::atomic<uint64_t> cycle_{0};
+
+    EventQueue<std::shared_ptr<Client>> ready_;
+    std::vector<std::thread> senders_;
+};
@@ -2,6 +2,7 @@
 #include <crow/middlewares/cors.h>
 #include <nlohmann/json.hpp>
 #include <cmath>
+#include <cstdio>
 #include <random>
 #include <vector>
 #include <string>
@@ -11,149 +12,81 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <mutex>
+#include <ctime>
+#include <atomic>
+#include <memory>
+#include <limits>
+
+#include "engine_config.h"
+#include "event_queue.h"
+#include "financial_calculator.h"
+#include "thread_topology.h"
+#include "time_series_store.h"
+#include "timing_wheel.h"
+#include "vol_surface.h"
+#include "ws_fanout.h"
 
 using json = nlohmann::json;
 using namespace std;
 
-// Financial calculation class with optimized algorithms
-class FinancialCalculator {
-private:
-    // Fast inverse normal CDF approximation
-    static double inverseNormalCDF(double p) {
-        if (p <= 0.0 || p >= 1.0) return 0.0;
-        
-        double x = p - 0.5;
-        if (abs(x) < 0.42) {
-            double r = x * x;
-            return x * ((((-25.44106049637 * r + 41.39119773534) * r 
-                        - 18.61500062529) * r + 2.50662823884) * r - 0.25449438889)
-                    / ((((3.13082909833 * r - 21.06224101826) * r 
-                        + 23.08336743743) * r - 8.47351093090) * r + 1.0);
-        }
-        
-        double r = (x > 0) ? 1.0 - p : p;
-        r = sqrt(-log(r));
-        
-        double result;
-        if (r < 5.0) {
-            r -= 1.6;
-            result = (((((0.007540014 * r + 0.032776263) * r + 0.104046394) * r 
-                     + 0.178644675) * r + 0.174420264) * r + 1.0) * r / 
-                    (((((0.015995094 * r + 0.154943985) * r + 0.544459638) * r 
-                     + 1.0) * r + 1.0) * r + 1.0);
-        } else {
-            r -= 5.0;
-            result = (((((0.000454004 * r + 0.010009993) * r + 0.043534261) * r 
-                     + 0.100012428) * r + 0.182741207) * r + 1.0) * r / 
-                    (((((0.001076324 * r + 0.013734698) * r + 0.089433576) * r 
-                     + 0.285324221) * r + 1.0) * r + 1.0);
-        }
-        
-        return (x > 0) ? result : -result;
-    }
-
-    // Normal CDF approximation using Hart's algorithm
-    static double normalCDF(double x) {
-        double a1 = 0.254829592;
-        double a2 = -0.284496736;
-        double a3 = 1.421413741;
-        double a4 = -1.453152027;
-        double a5 = 1.061405429;
-        double p = 0.3275911;
-        
-        int sign = (x >= 0) ? 1 : -1;
-        x = abs(x);
-        
-        double t = 1.0 / (1.0 + p * x);
-        double y = 1.0 - (((((a5 * t + a4) * t) + a3) * t + a2) * t + a1) * t * exp(-x * x);
-        
-        return 0.5 * (1.0 + sign * y);
-    }
+// Events delivered to the engine's dispatcher thread
+enum class EngineEventType {
+    Heartbeat,
+    SquareOffAlert,
+    HistorySample
+};
 
-public:
-    // High-performance Black-Scholes calculation
-    static double blackScholesCall(double S, double K, double r, double T, double sigma) {
-        if (T <= 0) return max(S - K, 0.0);
-        
-        double d1 = (log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
-        double d2 = d1 - sigma * sqrt(T);
-        
-        return S * normalCDF(d1) - K * exp(-r * T) * normalCDF(d2);
-    }
-    
-    static double blackScholesPut(double S, double K, double r, double T, double sigma) {
-        if (T <= 0) return max(K - S, 0.0);
-        
-        double d1 = (log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
-        double d2 = d1 - sigma * sqrt(T);
-        
-        return K * exp(-r * T) * normalCDF(-d2) - S * normalCDF(-d1);
-    }
-    
-    // Vectorized calculations for multiple instruments
-    static json calculateBatchMetrics(const vector<double>& spots, const vector<double>& rates, 
-                                    const vector<double>& times, const vector<double>& volatilities) {
-        json result;
-        result["theoretical_values"] = json::array();
-        result["one_sdv"] = json::array();
-        result["two_sdv"] = json::array();
-        result["three_sdv"] = json::array();
-        result["call_prices"] = json::array();
-        result["put_prices"] = json::array();
-        
-        for (size_t i = 0; i < spots.size(); ++i) {
-            double spot = spots[i];
-            double rate = rates[i % rates.size()];
-            double time = times[i % times.size()];
-            double vol = volatilities[i % volatilities.size()];
-            
-            // Theoretical future value
-            double theoretical = spot * exp(rate * time);
-            result["theoretical_values"].push_back(round(theoretical * 100) / 100);
-            
-            // SDV levels
-            double sdv = spot * vol * sqrt(time);
-            result["one_sdv"].push_back(round(sdv * 100) / 100);
-            result["two_sdv"].push_back(round(2 * sdv * 100) / 100);
-            result["three_sdv"].push_back(round(3 * sdv * 100) / 100);
-            
-            // Option prices (ATM strike)
-            double call_price = blackScholesCall(spot, spot, rate, time, vol);
-            double put_price = blackScholesPut(spot, spot, rate, time, vol);
-            result["call_prices"].push_back(round(call_price * 100) / 100);
-            result["put_prices"].push_back(round(put_price * 100) / 100);
-        }
-        
-        return result;
-    }
-    
-    // Monte Carlo simulation for complex instruments
-    static double monteCarloOptionPrice(double S, double K, double r, double T, double sigma, 
-                                      int simulations = 100000, bool isCall = true) {
-        random_device rd;
-        mt19937 gen(rd());
-        normal_distribution<> d(0, 1);
-        
-        double sum = 0.0;
-        double dt = T;
-        double drift = (r - 0.5 * sigma * sigma) * dt;
-        double diffusion = sigma * sqrt(dt);
-        
-        #pragma omp parallel for reduction(+:sum)
-        for (int i = 0; i < simulations; ++i) {
-            double ST = S * exp(drift + diffusion * d(gen));
-            double payoff = isCall ? max(ST - K, 0.0) : max(K - ST, 0.0);
-            sum += payoff;
-        }
-        
-        return exp(-r * T) * sum / simulations;
-    }
+struct EngineEvent {
+    EngineEventType type = EngineEventType::Heartbeat;
+    crow::websocket::connection* conn = nullptr;
+    json payload;
 };
 
 // Global data storage
+EngineConfig config;
 map<string, json> marketData;
+mutex marketMutex;
 map<string, json> baskets;
-vector<crow::websocket::connection*> wsConnections;
+unique_ptr<WsFanout<crow::websocket::connection>> wsFanout;
+unique_ptr<VolSurfaceService> volSurfaces;
+unique_ptr<TimeSeriesStore> marketHistory;
+shared_ptr<const json> latestEnriched;   // last calc output, sampled into marketHistory
+mutex latestEnrichedMutex;
+
+// Fields kept in the session history for every instrument
+const vector<pair<string, json::json_pointer>> historyFields = {
+    {"spot", json::json_pointer("/spot")},
+    {"futures.price", json::json_pointer("/futures/price")},
+    {"futures.bid", json::json_pointer("/futures/bid")},
+    {"futures.ask", json::json_pointer("/futures/ask")},
+    {"futures.oi", json::json_pointer("/futures/oi")},
+    {"calls.bid", json::json_pointer("/options/calls/bid")},
+    {"calls.ask", json::json_pointer("/options/calls/ask")},
+    {"calls.ltp", json::json_pointer("/options/calls/ltp")},
+    {"puts.bid", json::json_pointer("/options/puts/bid")},
+    {"puts.ask", json::json_pointer("/options/puts/ask")},
+    {"puts.ltp", json::json_pointer("/options/puts/ltp")},
+    {"theoretical_value", json::json_pointer("/calculations/theoretical_value")},
+    {"call_price", json::json_pointer("/calculations/call_price")},
+    {"put_price", json::json_pointer("/calculations/put_price")}
+};
+
+// Feed -> calc -> broadcast pipeline; each stage only sees the latest value
+atomic<bool> engineRunning{true};
+LatestValue<uint64_t> marketTicks;
+LatestValue<shared_ptr<const vector<InstrumentUpdate>>> marketUpdates;
+
+// Time-driven work runs off a single timing wheel instead of sleeping threads
+const int squareOffAlertHour = 15;   // Intraday positions are auto squared off from 15:20 exchange time
+const int squareOffAlertMinute = 10;
+const int expiryCloseHour = 15;      // Exchange close on expiry day, exchange time
+const int expiryCloseMinute = 30;
+
+EventQueue<EngineEvent> engineEvents;
+TimerScheduler<EngineEvent> timerScheduler(engineEvents, chrono::milliseconds(10), 4096);
+map<crow::websocket::connection*, TimerScheduler<EngineEvent>::TimerId> heartbeatTimers;
+mutex heartbeatMutex;
 
 // Initialize sample market data
 void initializeMarketData() {
@@ -209,12 +142,20 @@ void initializeMarketData() {
 // Enhanced market data with calculations
 json getEnrichedMarketData() {
     vector<double> spots, rates, times, vols;
+    lock_guard<mutex> lock(marketMutex);
     
     for (const auto& [ticker, data] : marketData) {
-        spots.push_back(data["spot"]);
-        rates.push_back(0.064); // 6.4% default
-        times.push_back(30.0 / 365.0); // 30 days
-        vols.push_back(0.25); // 25% volatility
+        double spot = data["spot"];
+        double time = config.defaultTimeToExpiryDays / 365.0;
+        double vol = config.defaultVolatility;
+        
+        // ATM vol off the calibrated surface; flat default until one is posted
+        volSurfaces->volatilities(ticker, &spot, &time, 1, &vol);
+        
+        spots.push_back(spot);
+        rates.push_back(config.defaultRate);
+        times.push_back(time);
+        vols.push_back(vol);
     }
     
     auto calculations = FinancialCalculator::calculateBatchMetrics(spots, rates, times, vols);
@@ -245,16 +186,24 @@ json getEnrichedMarketData() {
     return enrichedData;
 }
 
-// WebSocket message broadcaster
-void broadcastMarketUpdate() {
-    while (true) {
-        this_thread::sleep_for(chrono::seconds(3));
+// Market feed: advances prices on a fixed cadence
+void runMarketFeed() {
+    applyThreadRole("feed", config.feed);
+    
+    random_device rd;
+    mt19937 gen(rd());
+    normal_distribution<> d(0, 1.0);
+    
+    auto interval = chrono::milliseconds(max(1, config.updateIntervalMs));
+    auto nextUpdate = chrono::steady_clock::now();
+    uint64_t tick = 0;
+    
+    while (engineRunning) {
+        nextUpdate += interval;
+        waitUntil(nextUpdate, config.feed.busyPoll);
         
         // Update prices with random walk
-        random_device rd;
-        mt19937 gen(rd());
-        normal_distribution<> d(0, 1.0);
-        
+        lock_guard<mutex> lock(marketMutex);
         for (auto& [ticker, data] : marketData) {
             double currentSpot = data["spot"];
             double change = d(gen);
@@ -266,33 +215,333 @@ void broadcastMarketUpdate() {
             data["futures"]["bid"] = round((newSpot * 0.995) * 100) / 100;
             data["futures"]["ask"] = round((newSpot * 1.005) * 100) / 100;
         }
+        marketTicks.publish(++tick);
+    }
+}
+
+// Appends one snapshot of an enriched instrument to the session history
+void recordHistory(const json& instrument, int64_t timestamp) {
+    const string& ticker = instrument["ticker"].get_ref<const string&>();
+    for (const auto& [field, pointer] : historyFields) {
+        if (!instrument.contains(pointer)) continue;
+        const json& value = instrument[pointer];
+        if (value.is_number()) {
+            marketHistory->append(ticker, field, timestamp, value.get<double>());
+        }
+    }
+}
+
+// Runs on the history timer, so samples keep their own cadence whatever the
+// feed interval; between feed ticks the latest calculated state repeats
+void recordHistorySample() {
+    static int64_t lastSample = numeric_limits<int64_t>::min();  // event thread only
+    
+    int64_t sampleMs = max(1, config.historySampleIntervalMs);
+    int64_t now = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    int64_t sample = now - now % sampleMs;   // stamped on the interval boundary
+    if (sample == lastSample) return;
+    
+    shared_ptr<const json> enriched;
+    {
+        lock_guard<mutex> lock(latestEnrichedMutex);
+        enriched = latestEnriched;
+    }
+    if (!enriched) return;
+    
+    lastSample = sample;
+    for (const auto& instrument : *enriched) {
+        recordHistory(instrument, sample);
+    }
+}
+
+// Calculation stage: prices each new market state and serializes each
+// instrument once, so client queues can conflate per ticker
+void runCalculations() {
+    applyThreadRole("calc", config.calc);
+    
+    uint64_t seen = 0;
+    uint64_t tick = 0;
+    while (marketTicks.waitNewer(seen, tick, config.calc.busyPoll, engineRunning)) {
+        auto enriched = make_shared<const json>(getEnrichedMarketData());
         
-        if (!wsConnections.empty()) {
-            json update = {
-                {"type", "MARKET_UPDATE"},
-                {"data", getEnrichedMarketData()},
-                {"timestamp", chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count()}
-            };
-            
-            string message = update.dump();
-            
-            // Broadcast to all connected clients
-            for (auto* conn : wsConnections) {
-                if (conn) {
-                    conn->send_text(message);
+        auto updates = make_shared<vector<InstrumentUpdate>>();
+        for (const auto& instrument : *enriched) {
+            updates->emplace_back(instrument["ticker"].get<string>(), make_shared<const string>(instrument.dump()));
+        }
+        marketUpdates.publish(move(updates));
+        
+        lock_guard<mutex> lock(latestEnrichedMutex);
+        latestEnriched = move(enriched);
+    }
+}
+
+// Joins conflated instrument payloads into one MARKET_UPDATE frame
+string buildMarketUpdateFrame(const vector<SharedPayload>& updates) {
+    string frame = "{\"type\":\"MARKET_UPDATE\",\"timestamp\":";
+    frame += to_string(chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count());
+    frame += ",\"data\":[";
+    for (size_t i = 0; i < updates.size(); ++i) {
+        if (i > 0) frame += ',';
+        frame += *updates[i];
+    }
+    frame += "]}";
+    return frame;
+}
+
+// "YYYY-MM-DD" for a count of days since 1970-01-01 (proleptic Gregorian)
+string civilDate(int64_t days) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t mp = (5 * dayOfYear + 2) / 153;
+    int64_t day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+    
+    ostringstream date;
+    date << setfill('0') << setw(4) << year << '-' << setw(2) << month << '-' << setw(2) << day;
+    return date.str();
+}
+
+bool isTradingDay(int64_t days) {
+    int weekday = static_cast<int>((days % 7 + 11) % 7);  // 0 = Sunday; 1970-01-01 was a Thursday
+    if (weekday == 0 || weekday == 6) return false;
+    
+    const auto& holidays = config.exchangeHolidays;
+    return find(holidays.begin(), holidays.end(), civilDate(days)) == holidays.end();
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+int64_t daysFromCivil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2 ? 1 : 0;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+const int64_t dayMs = 24 * 3600 * 1000;
+
+// Exchange-local calendar day (days since 1970-01-01) of an instant
+int64_t exchangeDay(int64_t ms) {
+    int64_t local = ms + int64_t(config.exchangeUtcOffsetMinutes) * 60000;
+    return (local >= 0 ? local : local - (dayMs - 1)) / dayMs;
+}
+
+// Options expire at the close on their expiry day
+int64_t expiryCloseMs(int64_t days) {
+    return days * dayMs + int64_t(expiryCloseHour * 60 + expiryCloseMinute - config.exchangeUtcOffsetMinutes) * 60000;
+}
+
+// Expiry of a posted vol-surface slice (ms since epoch). "expiry" is a date,
+// "YYYY-MM-DD" or the feed's "28NOV25"; "expiry_days" / "time" resolve to the
+// exchange day they land on, so the same chain reposted a day later (29 days
+// instead of 30) addresses the same slices
+int64_t sliceExpiryMs(const json& slice, int64_t nowMs) {
+    if (!slice.contains("expiry")) {
+        double T = slice.contains("expiry_days") ? slice["expiry_days"].get<double>() / 365.0 : slice.at("time").get<double>();
+        return expiryCloseMs(exchangeDay(nowMs + llround(T * 365.0 * dayMs)));
+    }
+    
+    string text = slice["expiry"].get<string>();
+    int year = 0, month = 0, day = 0;
+    char monthName[4] = {};
+    if (sscanf(text.c_str(), "%4d-%2d-%2d", &year, &month, &day) != 3) {
+        static const string months = "JANFEBMARAPRMAYJUNJULAUGSEPOCTNOVDEC";
+        if (text.size() != 7 || sscanf(text.c_str(), "%2d%3[A-Za-z]%2d", &day, monthName, &year) != 3) {
+            throw invalid_argument("Unrecognised expiry " + text);
+        }
+        string name = monthName;
+        transform(name.begin(), name.end(), name.begin(), ::toupper);
+        size_t at = months.find(name);
+        if (name.size() != 3 || at == string::npos || at % 3 != 0) {
+            throw invalid_argument("Unrecognised expiry " + text);
+        }
+        month = static_cast<int>(at / 3) + 1;
+        year += 2000;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        throw invalid_argument("Unrecognised expiry " + text);
+    }
+    return expiryCloseMs(daysFromCivil(year, month, day));
+}
+
+// Calibrated surface summary returned by the vol-surface endpoints
+json volSurfaceToJson(const string& ticker, const VolSurfaceSnapshot& surface) {
+    int64_t nowMs = volSurfaceNowMs();
+    json slices = json::array();
+    for (const auto& slice : surface.slices()) {
+        // Slices expiring since the snapshot was published are not shown
+        double T = static_cast<double>(slice.expiry - nowMs) / kVolYearMs;
+        if (T <= 0) continue;
+        
+        slices.push_back({
+            {"expiry", civilDate(exchangeDay(slice.expiry))},
+            {"expiry_days", round(T * 365.0 * 100) / 100},
+            {"forward", slice.forward},
+            {"atm_vol", round(surface.volatility(slice.forward, T, nowMs) * 10000) / 10000},
+            {"svi", {
+                {"a", slice.params.a},
+                {"b", slice.params.b},
+                {"rho", slice.params.rho},
+                {"m", slice.params.m},
+                {"sigma", slice.params.sigma}
+            }},
+            {"rmse", slice.rmse},
+            {"butterfly_free", slice.butterflyFree},
+            {"calendar_free", slice.calendarFree},
+            {"lee_bounds", slice.withinLeeBounds}
+        });
+    }
+    
+    return {
+        {"ticker", ticker},
+        {"spot", surface.spot()},
+        {"rate", surface.rate()},
+        {"slices", slices}
+    };
+}
+
+FanoutPolicy fanoutPolicyFromConfig(const EngineConfig& engineConfig) {
+    FanoutPolicy policy;
+    policy.maxConnections = static_cast<size_t>(max(0, engineConfig.maxConnections));
+    policy.maxQueuedInstruments = static_cast<size_t>(max(1, engineConfig.sendQueueInstruments));
+    policy.lagCyclesBeforeAction = max(1, engineConfig.slowConsumerLagCycles);
+    policy.action = engineConfig.slowConsumerPolicy == "drop" ? SlowConsumerAction::Drop : SlowConsumerAction::Downgrade;
+    policy.downgradeInterval = max(1, engineConfig.downgradeInterval);
+    policy.slowConsumerBytes = static_cast<size_t>(max(1, engineConfig.slowConsumerKb)) * 1024;
+    policy.maxBufferedBytes = static_cast<size_t>(max(engineConfig.slowConsumerKb, engineConfig.maxBufferedKb)) * 1024;
+    policy.senderThreads = max(1, engineConfig.senderThreads);
+    return policy;
+}
+
+// WebSocket message broadcaster: enqueues into per-client channels only,
+// the fan-out's sender threads do the socket writes
+void runBroadcast() {
+    applyThreadRole("broadcast", config.broadcast);
+    
+    uint64_t seen = 0;
+    shared_ptr<const vector<InstrumentUpdate>> updates;
+    while (marketUpdates.waitNewer(seen, updates, config.broadcast.busyPoll, engineRunning)) {
+        wsFanout->publish(*updates);
+    }
+}
+
+// First hour:minute in exchange time (not the host's zone) on a trading day
+// strictly after `after`
+chrono::system_clock::time_point nextExchangeTime(int hour, int minute, chrono::system_clock::time_point after) {
+    auto offset = chrono::minutes(config.exchangeUtcOffsetMinutes);
+    int64_t sinceEpochMin = chrono::duration_cast<chrono::minutes>((after + offset).time_since_epoch()).count();
+    int64_t days = (sinceEpochMin >= 0 ? sinceEpochMin : sinceEpochMin - 1439) / 1440;
+    
+    // Bounded so a misconfigured calendar cannot spin forever
+    for (int i = 0; i < 366 * 2; ++i, ++days) {
+        auto target = chrono::system_clock::time_point(chrono::hours(24) * days + chrono::hours(hour) + chrono::minutes(minute)) - offset;
+        if (target > after && isTradingDay(days)) {
+            return target;
+        }
+    }
+    return after + chrono::hours(24);
+}
+
+// One-shot per trading day; each alert schedules the next from its own
+// target time (not from when it ran), so one alert can never re-arm for the
+// same day, and weekends and holidays are skipped
+void scheduleSquareOffAlert(chrono::system_clock::time_point after) {
+    auto target = nextExchangeTime(squareOffAlertHour, squareOffAlertMinute, after);
+    timerScheduler.scheduleAt(
+        target,
+        EngineEvent{EngineEventType::SquareOffAlert, nullptr, {
+            {"message", "Square off intraday short positions before 15:20 to avoid broker penalties"},
+            {"scheduled_for", chrono::duration_cast<chrono::milliseconds>(target.time_since_epoch()).count()}
+        }});
+}
+
+// Engine event dispatcher: executes everything the timer wheel fires
+void processEngineEvents() {
+    vector<EngineEvent> events;
+    while (!engineEvents.closed()) {
+        if (!engineEvents.drain(events, chrono::milliseconds(500))) continue;
+        
+        for (auto& event : events) {
+            switch (event.type) {
+                case EngineEventType::Heartbeat: {
+                    // The connection may have closed after the timer fired
+                    wsFanout->withConnection(event.conn, [](crow::websocket::connection& conn) {
+                        conn.send_ping("");
+                    });
+                    break;
+                }
+                case EngineEventType::SquareOffAlert: {
+                    json alert = {
+                        {"type", "SQUARE_OFF_ALERT"},
+                        {"data", event.payload},
+                        {"timestamp", chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count()}
+                    };
+                    cout << "Square-off alert: " << event.payload.value("message", "") << endl;
+                    wsFanout->broadcastControl(make_shared<const string>(alert.dump()));
+                    scheduleSquareOffAlert(chrono::system_clock::time_point(
+                        chrono::milliseconds(event.payload.value("scheduled_for", int64_t(0)))));
+                    break;
+                }
+                case EngineEventType::HistorySample: {
+                    recordHistorySample();
+                    break;
                 }
             }
         }
+        events.clear();
     }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Load configuration (path may be given as the first argument)
+    config = EngineConfig::load(argc > 1 ? argv[1] : "config.json");
+    
     // Initialize data
     initializeMarketData();
     
-    // Start background thread for market updates
-    thread marketThread(broadcastMarketUpdate);
-    marketThread.detach();
+    // Per-underlying volatility surfaces, flat default until calibrated
+    volSurfaces = make_unique<VolSurfaceService>(config.defaultVolatility);
+    
+    // Compressed per-second history for the current session
+    if (config.historyEnabled) {
+        marketHistory = make_unique<TimeSeriesStore>(
+            static_cast<size_t>(max(1, config.historyChunkPoints)),
+            static_cast<int64_t>(config.historyRetentionHours) * 3600 * 1000);
+    }
+    
+    // Per-client send queues and the sender threads that drain them
+    wsFanout = make_unique<WsFanout<crow::websocket::connection>>(fanoutPolicyFromConfig(config), buildMarketUpdateFrame);
+    wsFanout->start(config.sender);
+    if (!WsFanout<crow::websocket::connection>::kTracksBufferedBytes) {
+        cerr << "Crow websocket has no buffered_amount(); slow clients are detected from queued updates only" << endl;
+    }
+    
+    // Start timer wheel and the dispatcher that handles its events
+    timerScheduler.start();
+    thread eventThread(processEngineEvents);
+    
+    // Reminder ahead of the broker's intraday auto square-off on each trading day
+    scheduleSquareOffAlert(chrono::system_clock::now());
+    
+    // Session history samples, first one on the next interval boundary
+    if (marketHistory) {
+        auto interval = chrono::milliseconds(max(1, config.historySampleIntervalMs));
+        auto sinceEpoch = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch());
+        timerScheduler.scheduleAfter(
+            interval - sinceEpoch % interval,
+            EngineEvent{EngineEventType::HistorySample, nullptr, nullptr},
+            interval);
+    }
+    
+    // Start market pipeline threads; each pins itself per config topology
+    thread feedThread(runMarketFeed);
+    thread calcThread(runCalculations);
+    thread broadcastThread(runBroadcast);
     
     // Create Crow app with CORS
     crow::App<crow::CORSHandler> app;
@@ -337,6 +586,7 @@ int main() {
         string upperTicker = ticker;
         transform(upperTicker.begin(), upperTicker.end(), upperTicker.begin(), ::toupper);
         
+        lock_guard<mutex> lock(marketMutex);
         if (marketData.find(upperTicker) != marketData.end()) {
             return crow::response(200, marketData[upperTicker].dump());
         }
@@ -350,6 +600,7 @@ int main() {
         
         try {
             json requestData = json::parse(req.body);
+            lock_guard<mutex> lock(marketMutex);
             
             if (marketData.find(upperTicker) != marketData.end()) {
                 // Update existing
@@ -377,6 +628,148 @@ int main() {
         }
     });
     
+    // Volatility surface: post an option chain to (re)calibrate
+    CROW_ROUTE(app, "/api/vol-surface/<string>").methods("POST"_method)([](const crow::request& req, const string& ticker){
+        string upperTicker = ticker;
+        transform(upperTicker.begin(), upperTicker.end(), upperTicker.begin(), ::toupper);
+        
+        try {
+            json chain = json::parse(req.body);
+            double spot = chain.at("spot").get<double>();
+            double rate = chain.value("rate", config.defaultRate);
+            if (spot <= 0) {
+                return crow::response(400, json{{"error", "spot must be positive"}}.dump());
+            }
+            
+            VolSurface& surface = volSurfaces->surface(upperTicker);
+            surface.setMarket(spot, rate);
+            
+            // Slices are keyed by expiry date; T is always measured from now
+            int64_t nowMs = volSurfaceNowMs();
+            vector<int64_t> expiries;
+            for (const auto& slice : chain.at("slices")) {
+                int64_t expiry = sliceExpiryMs(slice, nowMs);
+                if (expiry <= nowMs) continue;
+                double T = static_cast<double>(expiry - nowMs) / kVolYearMs;
+                expiries.push_back(expiry);
+                
+                // Quotes may carry an implied vol directly or a call/put price
+                vector<SmileQuote> quotes;
+                for (const auto& quote : slice.at("quotes")) {
+                    double strike = quote.at("strike").get<double>();
+                    double iv = 0.0;
+                    if (quote.contains("iv")) {
+                        iv = quote["iv"].get<double>();
+                    } else if (quote.contains("call")) {
+                        iv = FinancialCalculator::impliedVolatility(quote["call"].get<double>(), spot, strike, rate, T, true);
+                    } else if (quote.contains("put")) {
+                        iv = FinancialCalculator::impliedVolatility(quote["put"].get<double>(), spot, strike, rate, T, false);
+                    }
+                    if (strike > 0 && iv > 0) {
+                        quotes.push_back({strike, iv});
+                    }
+                }
+                // Every quote filtered out: leave the slice as it was
+                if (quotes.empty()) continue;
+                surface.updateSlice(expiry, move(quotes));
+            }
+            
+            // The chain is complete: expiries it no longer lists are dropped
+            surface.retainExpiries(expiries);
+            size_t recalibrated = surface.recalibrate(nowMs, config.enableParallelProcessing);
+            auto snapshot = surface.snapshot();
+            if (!snapshot) {
+                return crow::response(400, json{{"error", "No usable quotes"}}.dump());
+            }
+            
+            json result = volSurfaceToJson(upperTicker, *snapshot);
+            result["recalibrated_slices"] = recalibrated;
+            return crow::response(200, result.dump());
+        } catch (const exception& e) {
+            return crow::response(400, json{{"error", "Invalid option chain"}}.dump());
+        }
+    });
+    
+    CROW_ROUTE(app, "/api/vol-surface/<string>").methods("GET"_method)([](const string& ticker){
+        string upperTicker = ticker;
+        transform(upperTicker.begin(), upperTicker.end(), upperTicker.begin(), ::toupper);
+        
+        auto snapshot = volSurfaces->snapshot(upperTicker);
+        if (!snapshot) {
+            return crow::response(404, json{{"error", "No surface for ticker"}}.dump());
+        }
+        return crow::response(200, volSurfaceToJson(upperTicker, *snapshot).dump());
+    });
+    
+    // Session history
+    CROW_ROUTE(app, "/api/history").methods("GET"_method)([](){
+        if (!marketHistory) {
+            return crow::response(404, json{{"error", "History is disabled"}}.dump());
+        }
+        auto [points, bytes] = marketHistory->usage();
+        return crow::response(200, json{
+            {"instruments", marketHistory->catalog()},
+            {"points", points},
+            {"bytes", bytes}
+        }.dump());
+    });
+    
+    CROW_ROUTE(app, "/api/history/<string>").methods("GET"_method)([](const crow::request& req, const string& ticker){
+        string upperTicker = ticker;
+        transform(upperTicker.begin(), upperTicker.end(), upperTicker.begin(), ::toupper);
+        
+        if (!marketHistory) {
+            return crow::response(404, json{{"error", "History is disabled"}}.dump());
+        }
+        
+        const char* fieldParam = req.url_params.get("field");
+        string field = fieldParam ? fieldParam : "spot";
+        int64_t from = 0;
+        int64_t to = numeric_limits<int64_t>::max();
+        int64_t intervalMs = 0;
+        try {
+            if (const char* value = req.url_params.get("from")) from = stoll(value);
+            if (const char* value = req.url_params.get("to")) to = stoll(value);
+            if (const char* value = req.url_params.get("interval_ms")) intervalMs = stoll(value);
+        } catch (const exception& e) {
+            return crow::response(400, json{{"error", "Invalid range"}}.dump());
+        }
+        if (from > to || intervalMs < 0) {
+            return crow::response(400, json{{"error", "Invalid range"}}.dump());
+        }
+        
+        auto series = marketHistory->find(upperTicker, field);
+        if (!series) {
+            return crow::response(404, json{{"error", "No history for ticker and field"}}.dump());
+        }
+        
+        json result = {{"ticker", upperTicker}, {"field", field}};
+        if (intervalMs > 0) {
+            // OHLC bars per interval, labelled by bucket start
+            json bars = json::array();
+            for (const auto& bar : series->resample(from, to, intervalMs)) {
+                bars.push_back({
+                    {"timestamp", bar.timestamp},
+                    {"open", bar.open},
+                    {"high", bar.high},
+                    {"low", bar.low},
+                    {"close", bar.close},
+                    {"count", bar.count}
+                });
+            }
+            result["interval_ms"] = intervalMs;
+            result["bars"] = move(bars);
+        } else {
+            // Raw samples as [timestamp, value] pairs
+            json points = json::array();
+            for (const auto& point : series->range(from, to)) {
+                points.push_back({point.timestamp, point.value});
+            }
+            result["points"] = move(points);
+        }
+        return crow::response(200, result.dump());
+    });
+    
     // Baskets management
     CROW_ROUTE(app, "/api/baskets").methods("GET"_method)([](){
         return json(baskets).dump();
@@ -412,19 +805,46 @@ int main() {
     // WebSocket endpoint
     CROW_ROUTE(app, "/ws").websocket()
         .onopen([&](crow::websocket::connection& conn){
-            wsConnections.push_back(&conn);
-            cout << "WebSocket client connected. Total clients: " << wsConnections.size() << endl;
+            // Refuse before building the snapshot; add() below still enforces the limit
+            if (wsFanout->full()) {
+                cout << "WebSocket client rejected: max_connections (" << config.maxConnections << ") reached" << endl;
+                conn.close("Server at capacity");
+                return;
+            }
             
-            // Send initial data
+            // Send initial data before registering so it precedes any update
             json initialData = {
                 {"type", "INITIAL_DATA"},
                 {"data", getEnrichedMarketData()}
             };
             conn.send_text(initialData.dump());
+            
+            if (!wsFanout->add(&conn)) {
+                cout << "WebSocket client rejected: max_connections (" << config.maxConnections << ") reached" << endl;
+                conn.close("Server at capacity");
+                return;
+            }
+            
+            {
+                lock_guard<mutex> lock(heartbeatMutex);
+                heartbeatTimers[&conn] = timerScheduler.scheduleAfter(
+                    chrono::seconds(config.heartbeatIntervalSec),
+                    EngineEvent{EngineEventType::Heartbeat, &conn, nullptr},
+                    chrono::seconds(config.heartbeatIntervalSec));
+            }
+            cout << "WebSocket client connected. Total clients: " << wsFanout->size() << endl;
         })
         .onclose([&](crow::websocket::connection& conn, const string& reason){
-            wsConnections.erase(remove(wsConnections.begin(), wsConnections.end(), &conn), wsConnections.end());
-            cout << "WebSocket client disconnected. Total clients: " << wsConnections.size() << endl;
+            wsFanout->remove(&conn);
+            {
+                lock_guard<mutex> lock(heartbeatMutex);
+                auto timer = heartbeatTimers.find(&conn);
+                if (timer != heartbeatTimers.end()) {
+                    timerScheduler.cancel(timer->second);
+                    heartbeatTimers.erase(timer);
+                }
+            }
+            cout << "WebSocket client disconnected. Total clients: " << wsFanout->size() << endl;
         })
         .onmessage([](crow::websocket::connection& /*conn*/, const string& data, bool /*is_binary*/){
             cout << "Received WebSocket message: " << data << endl;
@@ -433,13 +853,26 @@ int main() {
     cout << "==================================================" << endl;
     cout << "🚀 C++ High-Performance Backend Starting..." << endl;
     cout << "==================================================" << endl;
-    cout << "Server: http://localhost:5002" << endl;
-    cout << "WebSocket: ws://localhost:5002/ws" << endl;
+    cout << "Server: http://localhost:" << config.port << endl;
+    cout << "WebSocket: ws://localhost:" << config.port << "/ws" << endl;
     cout << "Market Data: " << marketData.size() << " instruments loaded" << endl;
+    cout << "Update Interval: " << config.updateIntervalMs << " ms, HTTP Threads: " << config.httpThreads << endl;
     cout << "Features: Real-time calculations, WebSocket, REST API" << endl;
     cout << "==================================================" << endl;
     
-    app.port(5002).multithreaded().run();
+    // Crow spawns its workers from this thread, so they inherit the HTTP placement
+    applyThreadRole("http", config.http);
+    app.bindaddr(config.host).port(config.port).concurrency(max(1, config.httpThreads)).run();
+    
+    // Shut down pipeline and timers once the server stops
+    engineRunning = false;
+    timerScheduler.stop();
+    engineEvents.close();
+    feedThread.join();
+    calcThread.join();
+    broadcastThread.join();
+    wsFanout->stop();
+    eventThread.join();
     
     return 0;
 }
\ No newline at end of file
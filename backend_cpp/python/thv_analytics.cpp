@@ -0,0 +1,322 @@
+// Python bindings for the thv_analytics pricing kernels.
+//
+// Written against the CPython and NumPy C APIs so the module builds from a
+// plain Python + NumPy install with no extra dependencies. Inputs that are
+// already C-contiguous float64 arrays are read in place; other dtypes,
+// layouts, lists and scalars are converted once by NumPy. Outputs are
+// allocated as NumPy arrays and written directly by the kernels. The GIL is
+// released for the duration of each batch so other Python threads keep
+// running while the kernels fan out across OpenMP workers.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+#include "financial_calculator.h"
+#include "vol_surface.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+static_assert(sizeof(bool) == sizeof(npy_bool), "is_call is passed to the kernels as bool*");
+
+namespace {
+
+// Owning reference to a Python object
+struct PyRef {
+    explicit PyRef(PyObject* object = nullptr) : ptr(object) {}
+    ~PyRef() { Py_XDECREF(ptr); }
+    PyRef(const PyRef&) = delete;
+    PyRef& operator=(const PyRef&) = delete;
+
+    PyObject* release() {
+        PyObject* object = ptr;
+        ptr = nullptr;
+        return object;
+    }
+
+    PyObject* ptr;
+};
+
+// One input column: a 0-d or 1-d C-contiguous array of `type`. NumPy hands
+// back the caller's own array (no copy) when it already matches.
+struct Column {
+    PyRef array;
+    const char* name;
+
+    npy_intp size() const { return PyArray_SIZE(reinterpret_cast<PyArrayObject*>(array.ptr)); }
+    void* data() const { return PyArray_DATA(reinterpret_cast<PyArrayObject*>(array.ptr)); }
+};
+
+bool toColumn(PyObject* object, int type, const char* name, Column& column) {
+    column.name = name;
+    column.array.ptr = PyArray_FROMANY(object, type, 0, 1, NPY_ARRAY_IN_ARRAY);
+    if (!column.array.ptr) {
+        PyErr_Format(PyExc_ValueError, "%s must be a number or a one-dimensional array", name);
+        return false;
+    }
+    return true;
+}
+
+// Common length of the inputs: length-1 columns (and scalars) broadcast,
+// everything else, including empty arrays, must agree
+bool batchSize(std::initializer_list<const Column*> columns, npy_intp& n) {
+    const Column* first = nullptr;
+    n = 1;
+    for (const Column* column : columns) {
+        npy_intp size = column->size();
+        if (size == 1) continue;
+        if (!first) {
+            first = column;
+            n = size;
+        } else if (size != n) {
+            PyErr_Format(PyExc_ValueError, "%s has %zd elements but %s has %zd",
+                         column->name, size, first->name, n);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Pointer to `n` elements of the column; a length-1 column is broadcast into `storage`
+template <typename T>
+const T* values(const Column& column, npy_intp n, std::vector<T>& storage) {
+    const T* data = static_cast<const T*>(column.data());
+    if (column.size() == n) return data;
+    storage.assign(static_cast<size_t>(n), *data);
+    return storage.data();
+}
+
+PyObject* newArray(npy_intp n) {
+    return PyArray_SimpleNew(1, &n, NPY_DOUBLE);
+}
+
+double* arrayData(PyObject* array) {
+    return static_cast<double*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(array)));
+}
+
+// Kernels only throw on allocation failure; surface it instead of aborting
+template <typename Fn>
+PyObject* guarded(Fn&& fn) {
+    try {
+        return fn();
+    } catch (const std::bad_alloc&) {
+        return PyErr_NoMemory();
+    } catch (const std::exception& e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+        return nullptr;
+    }
+}
+
+PyObject* blackScholes(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"spots", "strikes", "rates", "times", "vols", "threads", nullptr};
+    PyObject *spotsIn, *strikesIn, *ratesIn, *timesIn, *volsIn;
+    int threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOO|i", const_cast<char**>(keywords),
+                                     &spotsIn, &strikesIn, &ratesIn, &timesIn, &volsIn, &threads)) {
+        return nullptr;
+    }
+
+    return guarded([&]() -> PyObject* {
+        Column spots, strikes, rates, times, vols;
+        if (!toColumn(spotsIn, NPY_DOUBLE, "spots", spots) ||
+            !toColumn(strikesIn, NPY_DOUBLE, "strikes", strikes) ||
+            !toColumn(ratesIn, NPY_DOUBLE, "rates", rates) ||
+            !toColumn(timesIn, NPY_DOUBLE, "times", times) ||
+            !toColumn(volsIn, NPY_DOUBLE, "vols", vols)) {
+            return nullptr;
+        }
+
+        npy_intp n;
+        if (!batchSize({&spots, &strikes, &rates, &times, &vols}, n)) return nullptr;
+
+        std::vector<double> s0, s1, s2, s3, s4;
+        const double* S = values(spots, n, s0);
+        const double* K = values(strikes, n, s1);
+        const double* r = values(rates, n, s2);
+        const double* T = values(times, n, s3);
+        const double* v = values(vols, n, s4);
+
+        PyRef calls(newArray(n));
+        PyRef puts(newArray(n));
+        if (!calls.ptr || !puts.ptr) return nullptr;
+        double* callOut = arrayData(calls.ptr);
+        double* putOut = arrayData(puts.ptr);
+
+        Py_BEGIN_ALLOW_THREADS
+        FinancialCalculator::priceBatch(S, K, r, T, v, static_cast<size_t>(n), callOut, putOut, threads);
+        Py_END_ALLOW_THREADS
+
+        return Py_BuildValue("{s:N,s:N}", "call", calls.release(), "put", puts.release());
+    });
+}
+
+PyObject* impliedVol(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"prices", "spots", "strikes", "rates", "times", "is_call", "threads", nullptr};
+    PyObject *pricesIn, *spotsIn, *strikesIn, *ratesIn, *timesIn, *isCallIn;
+    int threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOOO|i", const_cast<char**>(keywords),
+                                     &pricesIn, &spotsIn, &strikesIn, &ratesIn, &timesIn, &isCallIn, &threads)) {
+        return nullptr;
+    }
+
+    return guarded([&]() -> PyObject* {
+        Column prices, spots, strikes, rates, times, isCall;
+        if (!toColumn(pricesIn, NPY_DOUBLE, "prices", prices) ||
+            !toColumn(spotsIn, NPY_DOUBLE, "spots", spots) ||
+            !toColumn(strikesIn, NPY_DOUBLE, "strikes", strikes) ||
+            !toColumn(ratesIn, NPY_DOUBLE, "rates", rates) ||
+            !toColumn(timesIn, NPY_DOUBLE, "times", times) ||
+            !toColumn(isCallIn, NPY_BOOL, "is_call", isCall)) {
+            return nullptr;
+        }
+
+        npy_intp n;
+        if (!batchSize({&prices, &spots, &strikes, &rates, &times, &isCall}, n)) return nullptr;
+
+        std::vector<double> s0, s1, s2, s3, s4;
+        std::vector<npy_bool> s5;
+        const double* P = values(prices, n, s0);
+        const double* S = values(spots, n, s1);
+        const double* K = values(strikes, n, s2);
+        const double* r = values(rates, n, s3);
+        const double* T = values(times, n, s4);
+        const bool* flags = reinterpret_cast<const bool*>(values(isCall, n, s5));
+
+        PyRef vols(newArray(n));
+        if (!vols.ptr) return nullptr;
+        double* out = arrayData(vols.ptr);
+
+        Py_BEGIN_ALLOW_THREADS
+        FinancialCalculator::impliedVolatilityBatch(P, S, K, r, T, flags, static_cast<size_t>(n), out, threads);
+        Py_END_ALLOW_THREADS
+
+        return vols.release();
+    });
+}
+
+PyObject* futuresMetrics(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"spots", "rates", "times", "vols", "threads", nullptr};
+    PyObject *spotsIn, *ratesIn, *timesIn, *volsIn;
+    int threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOO|i", const_cast<char**>(keywords),
+                                     &spotsIn, &ratesIn, &timesIn, &volsIn, &threads)) {
+        return nullptr;
+    }
+
+    return guarded([&]() -> PyObject* {
+        Column spots, rates, times, vols;
+        if (!toColumn(spotsIn, NPY_DOUBLE, "spots", spots) ||
+            !toColumn(ratesIn, NPY_DOUBLE, "rates", rates) ||
+            !toColumn(timesIn, NPY_DOUBLE, "times", times) ||
+            !toColumn(volsIn, NPY_DOUBLE, "vols", vols)) {
+            return nullptr;
+        }
+
+        npy_intp n;
+        if (!batchSize({&spots, &rates, &times, &vols}, n)) return nullptr;
+
+        std::vector<double> s0, s1, s2, s3;
+        const double* S = values(spots, n, s0);
+        const double* r = values(rates, n, s1);
+        const double* T = values(times, n, s2);
+        const double* v = values(vols, n, s3);
+
+        PyRef theoretical(newArray(n));
+        PyRef oneSdv(newArray(n));
+        if (!theoretical.ptr || !oneSdv.ptr) return nullptr;
+        double* theoreticalOut = arrayData(theoretical.ptr);
+        double* sdvOut = arrayData(oneSdv.ptr);
+
+        Py_BEGIN_ALLOW_THREADS
+        FinancialCalculator::futuresMetricsBatch(S, r, T, v, static_cast<size_t>(n), theoreticalOut, sdvOut, threads);
+        Py_END_ALLOW_THREADS
+
+        return Py_BuildValue("{s:N,s:N}", "theoretical_value", theoretical.release(), "one_sdv", oneSdv.release());
+    });
+}
+
+PyObject* sviFit(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"strikes", "ivs", "forward", "time", nullptr};
+    PyObject *strikesIn, *ivsIn;
+    double forward, T;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOdd", const_cast<char**>(keywords),
+                                     &strikesIn, &ivsIn, &forward, &T)) {
+        return nullptr;
+    }
+
+    return guarded([&]() -> PyObject* {
+        Column strikes, ivs;
+        if (!toColumn(strikesIn, NPY_DOUBLE, "strikes", strikes) ||
+            !toColumn(ivsIn, NPY_DOUBLE, "ivs", ivs)) {
+            return nullptr;
+        }
+
+        npy_intp n;
+        if (!batchSize({&strikes, &ivs}, n)) return nullptr;
+
+        std::vector<double> s0, s1;
+        const double* K = values(strikes, n, s0);
+        const double* iv = values(ivs, n, s1);
+
+        std::vector<SmileQuote> quotes(static_cast<size_t>(n));
+        for (npy_intp i = 0; i < n; ++i) quotes[i] = {K[i], iv[i]};
+
+        SviFitResult fit;
+        Py_BEGIN_ALLOW_THREADS
+        fit = SviCalibrator::fit(quotes, forward, T);
+        Py_END_ALLOW_THREADS
+
+        return Py_BuildValue("{s:O,s:d,s:d,s:d,s:d,s:d,s:d,s:O,s:O}",
+                             "valid", fit.valid ? Py_True : Py_False,
+                             "a", fit.params.a,
+                             "b", fit.params.b,
+                             "rho", fit.params.rho,
+                             "m", fit.params.m,
+                             "sigma", fit.params.sigma,
+                             "rmse", fit.rmse,
+                             "butterfly_free", fit.butterflyFree ? Py_True : Py_False,
+                             "lee_bounds", fit.withinLeeBounds ? Py_True : Py_False);
+    });
+}
+
+PyMethodDef methods[] = {
+    {"black_scholes", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(blackScholes)),
+     METH_VARARGS | METH_KEYWORDS,
+     "black_scholes(spots, strikes, rates, times, vols, threads=0)\n"
+     "Black-Scholes call and put prices; returns {'call': ndarray, 'put': ndarray}"},
+    {"implied_vol", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(impliedVol)),
+     METH_VARARGS | METH_KEYWORDS,
+     "implied_vol(prices, spots, strikes, rates, times, is_call, threads=0)\n"
+     "Implied volatility per option price (0 where no volatility reproduces the price)"},
+    {"futures_metrics", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(futuresMetrics)),
+     METH_VARARGS | METH_KEYWORDS,
+     "futures_metrics(spots, rates, times, vols, threads=0)\n"
+     "Theoretical future value and one-SDV move; returns {'theoretical_value', 'one_sdv'}"},
+    {"svi_fit", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(sviFit)),
+     METH_VARARGS | METH_KEYWORDS,
+     "svi_fit(strikes, ivs, forward, time)\n"
+     "Fit a raw SVI smile to one expiry slice; times are in years"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyModuleDef moduleDef = {
+    PyModuleDef_HEAD_INIT,
+    "thv_analytics",
+    "Native pricing and analytics kernels shared with the C++ backend",
+    -1,
+    methods,
+    nullptr, nullptr, nullptr, nullptr
+};
+
+}
+
+PyMODINIT_FUNC PyInit_thv_analytics() {
+    import_array();
+    return PyModule_Create(&moduleDef);
+}
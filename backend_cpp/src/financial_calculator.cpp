@@ -0,0 +1,206 @@
+#include "financial_calculator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using json = nlohmann::json;
+using namespace std;
+
+namespace {
+
+// Worker count for the batch kernels; always 1 without OpenMP
+int resolveThreads(int threads) {
+#ifdef _OPENMP
+    return threads > 0 ? threads : omp_get_max_threads();
+#else
+    (void)threads;
+    return 1;
+#endif
+}
+
+}
+
+double FinancialCalculator::inverseNormalCDF(double p) {
+    if (p <= 0.0 || p >= 1.0) return 0.0;
+    
+    double x = p - 0.5;
+    if (abs(x) < 0.42) {
+        double r = x * x;
+        return x * ((((-25.44106049637 * r + 41.39119773534) * r 
+                    - 18.61500062529) * r + 2.50662823884) * r - 0.25449438889)
+                / ((((3.13082909833 * r - 21.06224101826) * r 
+                    + 23.08336743743) * r - 8.47351093090) * r + 1.0);
+    }
+    
+    double r = (x > 0) ? 1.0 - p : p;
+    r = sqrt(-log(r));
+    
+    double result;
+    if (r < 5.0) {
+        r -= 1.6;
+        result = (((((0.007540014 * r + 0.032776263) * r + 0.104046394) * r 
+                 + 0.178644675) * r + 0.174420264) * r + 1.0) * r / 
+                (((((0.015995094 * r + 0.154943985) * r + 0.544459638) * r 
+                 + 1.0) * r + 1.0) * r + 1.0);
+    } else {
+        r -= 5.0;
+        result = (((((0.000454004 * r + 0.010009993) * r + 0.043534261) * r 
+                 + 0.100012428) * r + 0.182741207) * r + 1.0) * r / 
+                (((((0.001076324 * r + 0.013734698) * r + 0.089433576) * r 
+                 + 0.285324221) * r + 1.0) * r + 1.0);
+    }
+    
+    return (x > 0) ? result : -result;
+}
+
+double FinancialCalculator::normalCDF(double x) {
+    // Phi(x) = erfc(-x / sqrt(2)) / 2; erfc keeps full precision in the lower tail
+    return 0.5 * erfc(-x / sqrt(2.0));
+}
+
+double FinancialCalculator::blackScholesCall(double S, double K, double r, double T, double sigma) {
+    if (T <= 0) return max(S - K, 0.0);
+    
+    double d1 = (log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
+    double d2 = d1 - sigma * sqrt(T);
+    
+    return S * normalCDF(d1) - K * exp(-r * T) * normalCDF(d2);
+}
+
+double FinancialCalculator::blackScholesPut(double S, double K, double r, double T, double sigma) {
+    if (T <= 0) return max(K - S, 0.0);
+    
+    double d1 = (log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
+    double d2 = d1 - sigma * sqrt(T);
+    
+    return K * exp(-r * T) * normalCDF(-d2) - S * normalCDF(-d1);
+}
+
+double FinancialCalculator::impliedVolatility(double price, double S, double K, double r, double T, bool isCall) {
+    if (T <= 0 || price <= 0) return 0.0;
+    
+    double intrinsic = isCall ? max(S - K * exp(-r * T), 0.0) : max(K * exp(-r * T) - S, 0.0);
+    double upperBound = isCall ? S : K * exp(-r * T);
+    if (price <= intrinsic || price >= upperBound) return 0.0;
+    
+    double lo = 1e-4, hi = 5.0;
+    double sigma = 0.25;
+    for (int i = 0; i < 100; ++i) {
+        double value = isCall ? blackScholesCall(S, K, r, T, sigma) : blackScholesPut(S, K, r, T, sigma);
+        double diff = value - price;
+        if (abs(diff) < 1e-8) break;
+        
+        if (diff > 0) hi = sigma; else lo = sigma;
+        
+        double d1 = (log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * sqrt(T));
+        double vega = S * sqrt(T) * exp(-0.5 * d1 * d1) / 2.5066282746310002;  // sqrt(2*pi)
+        double next = vega > 1e-12 ? sigma - diff / vega : 0.5 * (lo + hi);
+        sigma = (next > lo && next < hi) ? next : 0.5 * (lo + hi);
+    }
+    
+    return sigma;
+}
+
+json FinancialCalculator::calculateBatchMetrics(const vector<double>& spots, const vector<double>& rates, 
+                                                const vector<double>& times, const vector<double>& volatilities) {
+    json result;
+    result["theoretical_values"] = json::array();
+    result["one_sdv"] = json::array();
+    result["two_sdv"] = json::array();
+    result["three_sdv"] = json::array();
+    result["call_prices"] = json::array();
+    result["put_prices"] = json::array();
+    
+    for (size_t i = 0; i < spots.size(); ++i) {
+        double spot = spots[i];
+        double rate = rates[i % rates.size()];
+        double time = times[i % times.size()];
+        double vol = volatilities[i % volatilities.size()];
+        
+        // Theoretical future value
+        double theoretical = spot * exp(rate * time);
+        result["theoretical_values"].push_back(round(theoretical * 100) / 100);
+        
+        // SDV levels
+        double sdv = spot * vol * sqrt(time);
+        result["one_sdv"].push_back(round(sdv * 100) / 100);
+        result["two_sdv"].push_back(round(2 * sdv * 100) / 100);
+        result["three_sdv"].push_back(round(3 * sdv * 100) / 100);
+        
+        // Option prices (ATM strike)
+        double call_price = blackScholesCall(spot, spot, rate, time, vol);
+        double put_price = blackScholesPut(spot, spot, rate, time, vol);
+        result["call_prices"].push_back(round(call_price * 100) / 100);
+        result["put_prices"].push_back(round(put_price * 100) / 100);
+    }
+    
+    return result;
+}
+
+void FinancialCalculator::priceBatch(const double* spots, const double* strikes, const double* rates,
+                                     const double* times, const double* volatilities, size_t n,
+                                     double* calls, double* puts, int threads) {
+    long count = static_cast<long>(n);
+    int workers = resolveThreads(threads);
+    (void)workers;
+    
+    #pragma omp parallel for schedule(static) num_threads(workers) if(workers > 1 && count > 1024)
+    for (long i = 0; i < count; ++i) {
+        if (calls) calls[i] = blackScholesCall(spots[i], strikes[i], rates[i], times[i], volatilities[i]);
+        if (puts) puts[i] = blackScholesPut(spots[i], strikes[i], rates[i], times[i], volatilities[i]);
+    }
+}
+
+void FinancialCalculator::impliedVolatilityBatch(const double* prices, const double* spots, const double* strikes,
+                                                 const double* rates, const double* times, const bool* isCall,
+                                                 size_t n, double* volatilities, int threads) {
+    long count = static_cast<long>(n);
+    int workers = resolveThreads(threads);
+    (void)workers;
+    
+    // Newton iteration counts vary per strike, so hand out work dynamically
+    #pragma omp parallel for schedule(dynamic, 256) num_threads(workers) if(workers > 1 && count > 256)
+    for (long i = 0; i < count; ++i) {
+        volatilities[i] = impliedVolatility(prices[i], spots[i], strikes[i], rates[i], times[i], isCall[i]);
+    }
+}
+
+void FinancialCalculator::futuresMetricsBatch(const double* spots, const double* rates, const double* times,
+                                              const double* volatilities, size_t n,
+                                              double* theoretical, double* oneSdv, int threads) {
+    long count = static_cast<long>(n);
+    int workers = resolveThreads(threads);
+    (void)workers;
+    
+    #pragma omp parallel for schedule(static) num_threads(workers) if(workers > 1 && count > 4096)
+    for (long i = 0; i < count; ++i) {
+        if (theoretical) theoretical[i] = spots[i] * exp(rates[i] * times[i]);
+        if (oneSdv) oneSdv[i] = spots[i] * volatilities[i] * sqrt(times[i]);
+    }
+}
+
+double FinancialCalculator::monteCarloOptionPrice(double S, double K, double r, double T, double sigma, 
+                                                int simulations, bool isCall) {
+    random_device rd;
+    mt19937 gen(rd());
+    normal_distribution<> d(0, 1);
+    
+    double sum = 0.0;
+    double dt = T;
+    double drift = (r - 0.5 * sigma * sigma) * dt;
+    double diffusion = sigma * sqrt(dt);
+    
+    #pragma omp parallel for reduction(+:sum)
+    for (int i = 0; i < simulations; ++i) {
+        double ST = S * exp(drift + diffusion * d(gen));
+        double payoff = isCall ? max(ST - K, 0.0) : max(K - ST, 0.0);
+        sum += payoff;
+    }
+    
+    return exp(-r * T) * sum / simulations;
+}
@@ -0,0 +1,139 @@
+"""Checks for the thv_analytics Python module (ctest, with -DTHV_BUILD_PYTHON=ON).
+
+Usage: python test_thv_analytics.py [directory containing the built module]
+
+Prices are compared with textbook Black-Scholes values rather than with the
+module itself, contiguous float64 inputs must not be copied, and batches must
+release the GIL.
+"""
+
+import sys
+import threading
+import time
+import tracemalloc
+
+if len(sys.argv) > 1:
+    sys.path.insert(0, sys.argv[1])
+
+import numpy as np
+import thv_analytics as ta
+
+# S, K, r, T, sigma, call, put (Hull; exact normal CDF)
+REFERENCES = np.array([
+    [100.0, 100.0, 0.00, 1.0, 0.20, 7.9655674554, 7.9655674554],
+    [100.0, 100.0, 0.05, 1.0, 0.20, 10.4505835722, 5.5735260223],
+    [42.0, 40.0, 0.10, 0.5, 0.20, 4.7594223929, 0.8085993729],
+    [50.0, 50.0, 0.10, 5.0 / 12.0, 0.40, 6.1165081293, 4.0759809848],
+    [2500.0, 2600.0, 0.064, 30.0 / 365.0, 0.25, 37.5302634606, 123.8894597681],
+])
+
+
+def check_reference_prices():
+    S, K, r, T, v, call, put = REFERENCES.T
+    prices = ta.black_scholes(S, K, r, T, v)
+    np.testing.assert_allclose(prices["call"], call, rtol=0, atol=1e-6)
+    np.testing.assert_allclose(prices["put"], put, rtol=0, atol=1e-6)
+
+    # Scalars broadcast against arrays
+    single = ta.black_scholes(100.0, [100.0, 100.0], 0.0, 1.0, 0.2)
+    np.testing.assert_allclose(single["call"], [7.9655674554] * 2, rtol=0, atol=1e-6)
+
+
+def check_implied_vol():
+    S, K, r, T, v, call, put = REFERENCES.T
+    np.testing.assert_allclose(ta.implied_vol(call, S, K, r, T, True), v, rtol=0, atol=1e-6)
+    np.testing.assert_allclose(ta.implied_vol(put, S, K, r, T, False), v, rtol=0, atol=1e-6)
+
+    # Mixed calls and puts from a boolean array
+    is_call = np.array([True, False, True, False, True])
+    quoted = np.where(is_call, call, put)
+    np.testing.assert_allclose(ta.implied_vol(quoted, S, K, r, T, is_call), v, rtol=0, atol=1e-6)
+
+
+def check_shapes_and_errors():
+    empty = ta.black_scholes([], [], [], [], [])
+    assert empty["call"].shape == (0,) and empty["put"].shape == (0,)
+    assert ta.implied_vol([], [], [], 0.05, [], True).shape == (0,)
+    assert ta.black_scholes(np.array([]), np.array([]), 0.05, np.array([]), 0.2)["call"].shape == (0,)
+
+    try:
+        ta.black_scholes([1.0, 2.0], [1.0, 2.0, 3.0], 0.05, 1.0, 0.2)
+    except ValueError:
+        pass
+    else:
+        raise AssertionError("mismatched lengths must raise ValueError")
+
+    metrics = ta.futures_metrics([100.0], 0.064, 30.0 / 365.0, 0.25)
+    np.testing.assert_allclose(metrics["theoretical_value"], [100.0 * np.exp(0.064 * 30.0 / 365.0)], rtol=1e-12)
+
+    assert not ta.svi_fit([], [], 100.0, 0.5)["valid"]
+
+
+def traced_peak(*args):
+    tracemalloc.start()
+    tracemalloc.reset_peak()
+    out = ta.black_scholes(*args)
+    _, peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+    del out
+    return peak
+
+
+def check_no_input_copies():
+    n = 500_000
+    rng = np.random.default_rng(1)
+    S = rng.uniform(50.0, 150.0, n)
+    K = S * rng.uniform(0.7, 1.3, n)
+    T = rng.uniform(0.02, 2.0, n)
+    v = rng.uniform(0.08, 0.9, n)
+    outputs = 2 * n * 8
+
+    # Contiguous float64 is used in place: only the two outputs are allocated
+    direct = traced_peak(S, K, 0.064, T, v)
+    assert direct < outputs * 1.05, (direct, outputs)
+
+    # Other dtypes and strides are converted, which the trace must show
+    converted = traced_peak(S.astype(np.float32), K, 0.064, T, v)
+    strided = traced_peak(np.repeat(S, 2)[::2], K, 0.064, T, v)
+    assert converted >= outputs + n * 8 and strided >= outputs + n * 8, (converted, strided)
+
+
+def check_gil_released():
+    n = 1_000_000
+    rng = np.random.default_rng(2)
+    S = rng.uniform(50.0, 150.0, n)
+    K = S * rng.uniform(0.7, 1.3, n)
+    T = rng.uniform(0.02, 2.0, n)
+    v = rng.uniform(0.08, 0.9, n)
+    calls = ta.black_scholes(S, K, 0.064, T, v)["call"]
+
+    ticks = 0
+    stop = False
+
+    def spin():
+        nonlocal ticks
+        while not stop:
+            ticks += 1
+
+    worker = threading.Thread(target=spin)
+    worker.start()
+    time.sleep(0.05)
+    before = ticks
+    ta.implied_vol(calls, S, K, 0.064, T, True)
+    during = ticks - before
+    stop = True
+    worker.join()
+    assert during > 1000, during
+
+
+def main():
+    check_reference_prices()
+    check_implied_vol()
+    check_shapes_and_errors()
+    check_no_input_copies()
+    check_gil_released()
+    print("thv_analytics: all checks passed")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,200 @@
+// Round-trip and query checks for the Gorilla-compressed session history.
+// Run through ctest; exits non-zero on the first failed check.
+
+#include "time_series_store.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+namespace {
+
+const int64_t sessionStart = 1760000000000;  // ms since epoch
+
+bool sameBits(double l, double r) {
+    return std::memcmp(&l, &r, sizeof(double)) == 0;
+}
+
+// One 6.5 h session of 1 s samples: tick-rounded random walk with flat
+// stretches, timestamps with jitter, gaps and a duplicate, and a few values
+// that stress the XOR window (sign flips, zero, NaN, infinities)
+std::vector<TimePoint> session() {
+    std::mt19937 gen(7);
+    std::normal_distribution<double> move(0.0, 1.0);
+    std::uniform_int_distribution<int> jitter(-40, 40);
+
+    std::vector<TimePoint> points;
+    double price = 2500.0;
+    int64_t t = sessionStart;
+    for (int i = 0; i < 23400; ++i) {
+        if (i % 3 != 0) price = std::round((price + move(gen)) * 20.0) / 20.0;
+        int64_t step = 1000;
+        if (i % 97 == 0) step += jitter(gen);          // 7- and 9-bit buckets
+        if (i % 1009 == 0) step += 1500;               // 12-bit bucket
+        if (i % 5003 == 0) step += 600000;             // 64-bit escape (feed outage)
+        if (i == 11) step = 0;                         // repeated timestamp
+        t += step;
+        points.push_back({t, price});
+    }
+    points[100].value = 0.0;
+    points[101].value = -price;
+    points[102].value = std::numeric_limits<double>::quiet_NaN();
+    points[103].value = std::numeric_limits<double>::infinity();
+    points[104].value = -std::numeric_limits<double>::infinity();
+    points[105].value = std::numeric_limits<double>::denorm_min();
+    return points;
+}
+
+void testRoundTrip() {
+    std::vector<TimePoint> expected = session();
+    for (size_t chunkPoints : {size_t(1), size_t(100), size_t(3600), size_t(100000)}) {
+        TimeSeriesStore store(chunkPoints);
+        for (const auto& point : expected) store.append("RELIANCE", "spot", point.timestamp, point.value);
+
+        auto series = store.find("RELIANCE", "spot");
+        CHECK(series);
+        CHECK(series->points() == expected.size());
+
+        auto decoded = series->range(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+        CHECK(decoded.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            CHECK(decoded[i].timestamp == expected[i].timestamp);
+            CHECK(sameBits(decoded[i].value, expected[i].value));
+        }
+    }
+
+    // 1 s ticks with mostly unchanged prices should stay well under 16 bytes/point
+    TimeSeriesStore store(3600);
+    for (const auto& point : expected) store.append("RELIANCE", "spot", point.timestamp, point.value);
+    auto [points, bytes] = store.usage();
+    std::printf("round trip: %zu points in %zu bytes (%.2f B/point)\n", points, bytes, double(bytes) / points);
+    CHECK(bytes < points * 8);
+}
+
+void testRange() {
+    std::vector<TimePoint> expected = session();
+    TimeSeriesStore store(500);
+    for (const auto& point : expected) store.append("TCS", "futures.price", point.timestamp, point.value);
+    auto series = store.find("TCS", "futures.price");
+
+    int64_t from = expected[4000].timestamp;
+    int64_t to = expected[9000].timestamp;
+    auto range = series->range(from, to);
+    CHECK(range.size() == 5001);
+    CHECK(range.front().timestamp == from);
+    CHECK(range.back().timestamp == to);
+
+    CHECK(series->range(expected.back().timestamp + 1, expected.back().timestamp + 1000).empty());
+    CHECK(!store.find("TCS", "spot"));
+    CHECK(!store.find("INFY", "futures.price"));
+}
+
+void testResample() {
+    std::vector<TimePoint> expected = session();
+    expected.resize(100);   // keep the special values out of the OHLC comparison
+    for (size_t i = 100; i < 20000; ++i) {
+        expected.push_back({expected.back().timestamp + 1000, 2500.0 + std::sin(i * 0.01) * 20.0});
+    }
+
+    TimeSeriesStore store(1000);
+    for (const auto& point : expected) store.append("SBIN", "spot", point.timestamp, point.value);
+    auto series = store.find("SBIN", "spot");
+
+    const int64_t bucketMs = 60000;
+    int64_t from = expected[150].timestamp;
+    int64_t to = expected[19000].timestamp;
+    auto bars = series->resample(from, to, bucketMs);
+
+    // Brute-force OHLC over the same window
+    std::vector<ResampledBar> reference;
+    for (const auto& point : expected) {
+        if (point.timestamp < from || point.timestamp > to) continue;
+        int64_t bucket = point.timestamp - point.timestamp % bucketMs;
+        if (reference.empty() || reference.back().timestamp != bucket) {
+            reference.push_back({bucket, point.value, point.value, point.value, point.value, 0});
+        }
+        ResampledBar& bar = reference.back();
+        bar.high = std::max(bar.high, point.value);
+        bar.low = std::min(bar.low, point.value);
+        bar.close = point.value;
+        ++bar.count;
+    }
+
+    CHECK(bars.size() == reference.size());
+    size_t total = 0;
+    for (size_t i = 0; i < bars.size(); ++i) {
+        CHECK(bars[i].timestamp == reference[i].timestamp);
+        CHECK(bars[i].timestamp % bucketMs == 0);
+        CHECK(bars[i].open == reference[i].open);
+        CHECK(bars[i].high == reference[i].high);
+        CHECK(bars[i].low == reference[i].low);
+        CHECK(bars[i].close == reference[i].close);
+        CHECK(bars[i].count == reference[i].count);
+        total += bars[i].count;
+    }
+    CHECK(total == 19000 - 150 + 1);
+    CHECK(series->resample(from, to, 0).empty());
+}
+
+void testOrderingAndRetention() {
+    TimeSeries series(10);
+    CHECK(series.append(5000, 1.0));
+    CHECK(!series.append(4000, 2.0));   // out of order is rejected
+    CHECK(series.append(5000, 3.0));    // equal timestamps are kept
+    CHECK(series.points() == 2);
+
+    // 1 h retention over 3 h of 1 s data keeps the last hour plus at most one chunk
+    TimeSeriesStore store(600, 3600 * 1000);
+    for (int64_t i = 0; i < 3 * 3600; ++i) store.append("LT", "spot", sessionStart + i * 1000, 100.0 + i % 7);
+    auto retained = store.find("LT", "spot")->range(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+    CHECK(retained.size() >= 3600);
+    CHECK(retained.size() <= 3600 + 600);
+    CHECK(retained.back().timestamp == sessionStart + (3 * 3600 - 1) * 1000);
+}
+
+void testConcurrentReaders() {
+    TimeSeriesStore store(256);
+    std::thread writer([&] {
+        for (int64_t i = 0; i < 50000; ++i) store.append("WIPRO", "spot", sessionStart + i * 1000, 400.0 + (i % 13) * 0.05);
+    });
+
+    // Every read is a consistent prefix: contiguous 1 s steps from the start
+    size_t reads = 0;
+    while (reads < 200) {
+        auto series = store.find("WIPRO", "spot");
+        if (!series) continue;
+        auto points = series->range(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+        for (size_t i = 0; i < points.size(); ++i) {
+            CHECK(points[i].timestamp == sessionStart + static_cast<int64_t>(i) * 1000);
+        }
+        ++reads;
+    }
+    writer.join();
+    CHECK(store.find("WIPRO", "spot")->points() == 50000);
+}
+
+}
+
+int main() {
+    testRoundTrip();
+    testRange();
+    testResample();
+    testOrderingAndRetention();
+    testConcurrentReaders();
+    std::printf("time_series_store: all checks passed\n");
+    return 0;
+}
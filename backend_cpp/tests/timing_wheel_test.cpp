@@ -0,0 +1,150 @@
+// Expiry checks for the hierarchical timing wheel and its scheduler thread.
+// Run through ctest; exits non-zero on the first failed check.
+
+#include "timing_wheel.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+namespace {
+
+// Every one-shot fires exactly on its tick, across all four levels and
+// their cascades, and cancelled timers never fire
+void testWheelExactTicks() {
+    std::mt19937_64 gen(11);
+    TimingWheel<uint64_t> wheel;
+    std::map<uint64_t, uint64_t> expected;   // payload -> expiry tick
+    std::set<uint64_t> cancelled;
+
+    uint64_t next = 1;
+    uint64_t fired = 0;
+    auto onFire = [&](TimingWheel<uint64_t>::TimerId, uint64_t payload) {
+        CHECK(!cancelled.count(payload));
+        auto it = expected.find(payload);
+        CHECK(it != expected.end());
+        CHECK(it->second == wheel.currentTick());
+        expected.erase(it);
+        ++fired;
+    };
+
+    for (int round = 0; round < 200; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            // Mix of short, level-boundary and multi-level delays
+            uint64_t delay;
+            switch (gen() % 4) {
+                case 0: delay = 1 + gen() % 300; break;
+                case 1: delay = 255 + gen() % 3; break;
+                case 2: delay = 1 + gen() % 70000; break;
+                default: delay = 1 + gen() % 20000000; break;
+            }
+            uint64_t payload = next++;
+            auto id = wheel.schedule(delay, payload);
+            expected[payload] = wheel.currentTick() + delay;
+            if (gen() % 10 == 0) {
+                CHECK(wheel.cancel(id));
+                CHECK(!wheel.cancel(id));
+                cancelled.insert(payload);
+                expected.erase(payload);
+            }
+        }
+        wheel.advance(wheel.currentTick() + 1 + gen() % 100000, onFire);
+    }
+    wheel.advance(wheel.currentTick() + 20000000, onFire);   // longest delay armed above
+    CHECK(expected.empty());
+    CHECK(wheel.size() == 0);
+    std::printf("wheel: %llu timers fired on their exact tick\n", static_cast<unsigned long long>(fired));
+}
+
+void testWheelPeriodic() {
+    TimingWheel<int> wheel;
+    std::vector<uint64_t> ticks;
+    TimingWheel<int>::TimerId periodic = wheel.schedule(3, 1, 300);
+    wheel.advance(3 + 300 * 9, [&](TimingWheel<int>::TimerId, int) { ticks.push_back(wheel.currentTick()); });
+
+    CHECK(ticks.size() == 10);
+    for (size_t i = 0; i < ticks.size(); ++i) CHECK(ticks[i] == 3 + 300 * i);
+    CHECK(wheel.cancel(periodic));
+    wheel.advance(wheel.currentTick() + 1000, [](TimingWheel<int>::TimerId, int) { CHECK(false); });
+}
+
+struct Deadline {
+    std::chrono::steady_clock::time_point steady;
+    std::chrono::system_clock::time_point system;
+};
+
+// The scheduler never delivers a timer before its deadline, whether it is
+// armed by delay or by wall-clock time, and is late by about a tick at most
+void testSchedulerNeverEarly() {
+    using namespace std::chrono;
+    const milliseconds tick(10);
+
+    EventQueue<Deadline> queue;
+    TimerScheduler<Deadline> scheduler(queue, tick);
+    scheduler.start();
+
+    const int timers = 400;
+    int received = 0;
+    microseconds worstLate(0);
+    std::thread consumer([&] {
+        std::vector<Deadline> events;
+        while (received < timers && queue.drain(events, seconds(2))) {
+            auto steadyNow = steady_clock::now();
+            auto systemNow = system_clock::now();
+            for (const auto& event : events) {
+                microseconds late = event.steady != steady_clock::time_point{}
+                    ? duration_cast<microseconds>(steadyNow - event.steady)
+                    : duration_cast<microseconds>(systemNow - event.system);
+                CHECK(late.count() >= 0);
+                worstLate = std::max(worstLate, late);
+            }
+            received += static_cast<int>(events.size());
+            events.clear();
+        }
+    });
+
+    std::mt19937 gen(3);
+    for (int i = 0; i < timers; ++i) {
+        if (i % 2 == 0) {
+            milliseconds delay(i % 4 == 0 ? 25 : static_cast<int>(gen() % 60));
+            auto now = steady_clock::now();
+            scheduler.scheduleAfter(delay, Deadline{now + delay, {}});
+        } else {
+            auto when = system_clock::now() + microseconds(gen() % 60000);
+            scheduler.scheduleAt(when, Deadline{{}, when});
+        }
+        // Spread arming across tick phases
+        std::this_thread::sleep_for(microseconds(gen() % 700));
+    }
+    consumer.join();
+    scheduler.stop();
+
+    CHECK(received == timers);
+    CHECK(worstLate < milliseconds(250));   // one tick plus generous scheduling noise
+    CHECK(scheduler.pending() == 0);
+    std::printf("scheduler: %d timers, none early, worst %.1f ms late\n", received, worstLate.count() / 1000.0);
+}
+
+}
+
+int main() {
+    testWheelExactTicks();
+    testWheelPeriodic();
+    testSchedulerNeverEarly();
+    std::printf("timing_wheel: all checks passed\n");
+    return 0;
+}
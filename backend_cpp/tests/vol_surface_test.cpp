@@ -0,0 +1,160 @@
+// Incremental calibration and expiry handling for the SVI surface. Run
+// through ctest; exits non-zero on the first failed check.
+
+#include "vol_surface.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                 \
+    do {                                                                        \
+        double a_ = (actual), e_ = (expected);                                  \
+        if (!(std::abs(a_ - e_) <= (tolerance))) {                              \
+            std::fprintf(stderr, "%s:%d: %s = %.8f, expected %.8f\n", __FILE__, __LINE__, #actual, a_, e_); \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+namespace {
+
+const int64_t dayMs = 24 * 3600 * 1000;
+const int64_t start = 1760000000000;   // ms since epoch
+
+// Flat smile around 100 at `vol`
+std::vector<SmileQuote> flatSmile(double vol) {
+    std::vector<SmileQuote> quotes;
+    for (double strike = 80.0; strike <= 120.0; strike += 5.0) quotes.push_back({strike, vol});
+    return quotes;
+}
+
+double years(int64_t ms) {
+    return static_cast<double>(ms) / kVolYearMs;
+}
+
+void testRepostNextDayRefitsNothing() {
+    VolSurface surface;
+    surface.setMarket(100.0, 0.0);
+    const int64_t expiries[] = {start + 7 * dayMs, start + 30 * dayMs, start + 60 * dayMs};
+    const double vols[] = {0.30, 0.25, 0.20};
+
+    for (int i = 0; i < 3; ++i) surface.updateSlice(expiries[i], flatSmile(vols[i]));
+    CHECK(surface.recalibrate(start, false) == 3);
+
+    // A day later the chain is reposted with the same quotes: 29 days to
+    // the second expiry instead of 30, same slices, nothing to refit
+    const int64_t nextDay = start + dayMs;
+    surface.setMarket(103.0, 0.0);
+    for (int i = 0; i < 3; ++i) CHECK(!surface.updateSlice(expiries[i], flatSmile(vols[i])));
+    CHECK(surface.retainExpiries({expiries[0], expiries[1], expiries[2]}) == 0);
+    CHECK(surface.recalibrate(nextDay, false) == 0);
+
+    auto snapshot = surface.snapshot();
+    CHECK(snapshot->slices().size() == 3);
+
+    // Each slice keeps its fitted vol at its current time to expiry
+    for (int i = 0; i < 3; ++i) {
+        double T = years(expiries[i] - nextDay);
+        CHECK_NEAR(snapshot->volatility(100.0, T, nextDay), vols[i], 2e-3);
+    }
+
+    // Between expiries total variance is linear in T
+    double T1 = years(expiries[1] - nextDay), T2 = years(expiries[2] - nextDay);
+    double T = 0.5 * (T1 + T2);
+    double w = 0.5 * (vols[1] * vols[1] * T1 + vols[2] * vols[2] * T2);
+    CHECK_NEAR(snapshot->volatility(100.0, T, nextDay), std::sqrt(w / T), 2e-3);
+
+    // Only the slice whose quotes changed is refit
+    CHECK(surface.updateSlice(expiries[1], flatSmile(0.27)));
+    CHECK(surface.recalibrate(nextDay, false) == 1);
+    CHECK_NEAR(surface.snapshot()->volatility(100.0, T1, nextDay), 0.27, 2e-3);
+}
+
+void testExpiriesDropped() {
+    VolSurface surface;
+    surface.setMarket(100.0, 0.0);
+    const int64_t near = start + 2 * dayMs, mid = start + 30 * dayMs, far = start + 90 * dayMs;
+    surface.updateSlice(near, flatSmile(0.40));
+    surface.updateSlice(mid, flatSmile(0.25));
+    surface.updateSlice(far, flatSmile(0.20));
+    CHECK(surface.recalibrate(start, false) == 3);
+
+    // An expiry missing from the next posted chain is withdrawn, with no refit
+    CHECK(surface.retainExpiries({near, far}) == 1);
+    CHECK(surface.recalibrate(start + 1000, false) == 0);
+    auto snapshot = surface.snapshot();
+    CHECK(snapshot->slices().size() == 2);
+    CHECK(snapshot->slices()[0].expiry == near && snapshot->slices()[1].expiry == far);
+
+    // A snapshot that outlives an expiry stops using it at lookup time ...
+    const int64_t later = near + dayMs;
+    double T = years(far - later);
+    CHECK_NEAR(snapshot->volatility(100.0, T, later), 0.20, 2e-3);
+    CHECK_NEAR(snapshot->volatility(100.0, 1.0 / 365.0, later), 0.20, 2e-3);
+
+    // ... and the next recalibration removes it
+    CHECK(surface.recalibrate(later, false) == 0);
+    CHECK(surface.snapshot()->slices().size() == 1);
+
+    // Once every expiry has passed the surface reports no data
+    double out = -1.0;
+    CHECK(!surface.snapshot()->volatilities(&T, &T, 1, &out, far + 1));
+    CHECK(out == -1.0);
+    surface.recalibrate(far + 1, false);
+    CHECK(!surface.snapshot());
+}
+
+void testServiceFallsBackAfterExpiry() {
+    VolSurfaceService service(0.18);
+    VolSurface& surface = service.surface("RELIANCE");
+    surface.setMarket(100.0, 0.0);
+    int64_t now = volSurfaceNowMs();
+    surface.updateSlice(now + 30 * dayMs, flatSmile(0.33));
+    CHECK(surface.recalibrate(now, false) == 1);
+
+    double strike = 100.0, T = 20.0 / 365.0, vol = 0.0;
+    service.volatilities("RELIANCE", &strike, &T, 1, &vol);
+    CHECK_NEAR(vol, 0.33, 2e-3);
+    service.volatilities("TCS", &strike, &T, 1, &vol);
+    CHECK(vol == 0.18);
+}
+
+void testEmptyAndStaleFits() {
+    VolSurface surface;
+    surface.setMarket(100.0, 0.0);
+    const int64_t expiry = start + 30 * dayMs;
+
+    // Nothing usable to fit is never published
+    surface.updateSlice(expiry, {{100.0, 0.0}});
+    CHECK(surface.recalibrate(start, false) == 1);
+    CHECK(!surface.snapshot());
+
+    // A slice dropped and re-added under the same expiry gets a fresh
+    // version, so it is fitted on its own quotes
+    surface.updateSlice(expiry, flatSmile(0.22));
+    CHECK(surface.retainExpiries({}) == 1);
+    surface.updateSlice(expiry, flatSmile(0.31));
+    CHECK(surface.recalibrate(start, false) == 1);
+    CHECK_NEAR(surface.snapshot()->volatility(100.0, years(expiry - start), start), 0.31, 2e-3);
+}
+
+}
+
+int main() {
+    testRepostNextDayRefitsNothing();
+    testExpiriesDropped();
+    testServiceFallsBackAfterExpiry();
+    testEmptyAndStaleFits();
+    std::printf("vol_surface: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,207 @@
+// Slow-consumer checks for the WebSocket fan-out against fake connections
+// that buffer like Crow's: send_text only appends, a network thread drains
+// the buffer at a fixed rate. Run through ctest; exits non-zero on the first
+// failed check.
+
+#include "ws_fanout.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+namespace {
+
+// Crow-like connection: never blocks, reports unsent bytes
+class FakeConnection {
+public:
+    explicit FakeConnection(size_t bytesPerMs) : bytesPerMs_(bytesPerMs) {
+        network_ = std::thread([this] {
+            while (running_) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                size_t buffered = buffered_.load();
+                buffered_ -= std::min(buffered, bytesPerMs_);
+            }
+        });
+    }
+
+    ~FakeConnection() {
+        running_ = false;
+        network_.join();
+    }
+
+    void send_text(const std::string& message) {
+        size_t buffered = buffered_ += message.size();
+        size_t peak = peak_;
+        while (buffered > peak && !peak_.compare_exchange_weak(peak, buffered)) {}
+        std::lock_guard<std::mutex> lock(mutex_);
+        frames_.push_back(message);
+    }
+
+    void close(const std::string&) { closed_ = true; }
+
+    size_t buffered_amount() const { return buffered_; }
+
+    size_t peak() const { return peak_; }
+    bool closed() const { return closed_; }
+
+    std::vector<std::string> frames() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return frames_;
+    }
+
+private:
+    const size_t bytesPerMs_;
+    std::atomic<size_t> buffered_{0};
+    std::atomic<size_t> peak_{0};
+    std::atomic<bool> closed_{false};
+    std::atomic<bool> running_{true};
+    std::thread network_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::string> frames_;
+};
+
+// An unpatched Crow connection: no buffered_amount()
+struct PlainConnection {
+    void send_text(const std::string& message) { frames.push_back(message); }
+    void close(const std::string&) { closed = true; }
+
+    std::vector<std::string> frames;
+    bool closed = false;
+};
+
+static_assert(WsFanout<FakeConnection>::kTracksBufferedBytes, "buffered_amount() should be detected");
+static_assert(!WsFanout<PlainConnection>::kTracksBufferedBytes, "plain connections must still build");
+
+// Frames are the concatenated update payloads
+std::string concatenate(const std::vector<SharedPayload>& updates) {
+    std::string frame;
+    for (const auto& payload : updates) frame += *payload;
+    return frame;
+}
+
+void testSlowConsumer(SlowConsumerAction action) {
+    FanoutPolicy policy;
+    policy.action = action;
+    policy.lagCyclesBeforeAction = 3;
+    policy.downgradeInterval = 4;
+    policy.slowConsumerBytes = 64 * 1024;
+    policy.maxBufferedBytes = 256 * 1024;
+    policy.senderThreads = 2;
+
+    WsFanout<FakeConnection> fanout(policy, concatenate);
+    fanout.start(ThreadRoleConfig{});
+
+    // 100 KB per 20 ms cycle: the fast client keeps up, the slow one drains 2 KB/ms
+    FakeConnection fast(1 << 20);
+    FakeConnection slow(2 * 1024);
+    CHECK(fanout.add(&fast));
+    CHECK(fanout.add(&slow));
+
+    const int cycles = 40;
+    const std::string body(50 * 1024, 'x');
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        auto payload = std::make_shared<const std::string>(std::to_string(cycle) + ":" + body);
+        fanout.publish({{"RELIANCE", payload}, {"TCS", payload}});
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    fanout.remove(&fast);
+    fanout.remove(&slow);
+    fanout.stop();
+
+    // The fast client sees every cycle, in order, and is left alone
+    auto frames = fast.frames();
+    CHECK(static_cast<int>(frames.size()) == cycles);
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        CHECK(frames[cycle].rfind(std::to_string(cycle) + ":", 0) == 0);
+    }
+    CHECK(!fast.closed());
+
+    // The slow client's unsent bytes stop growing once over the cap (at most
+    // one frame is handed over after the last sample below it)
+    CHECK(slow.peak() <= policy.maxBufferedBytes + 2 * (body.size() + 16));
+    if (action == SlowConsumerAction::Drop) {
+        CHECK(slow.closed());
+    } else {
+        CHECK(!slow.closed());
+        CHECK(slow.frames().size() < static_cast<size_t>(cycles) / 2);
+    }
+    std::printf("%s: fast %zu/%d frames, slow %zu frames, peak %zu KB unsent\n",
+                action == SlowConsumerAction::Drop ? "drop" : "downgrade",
+                frames.size(), cycles, slow.frames().size(), slow.peak() / 1024);
+}
+
+void testConflation() {
+    ClientChannel channel(2, 2);
+    auto payload = [](const char* text) { return std::make_shared<const std::string>(text); };
+    channel.offer("RELIANCE", payload("r1"));
+    channel.offer("TCS", payload("t1"));
+    channel.offer("RELIANCE", payload("r2"));   // replaces r1 in place
+    channel.offer("INFY", payload("i1"));       // over maxInstruments, dropped
+    channel.offerControl(payload("c1"));
+    channel.offerControl(payload("c2"));
+    channel.offerControl(payload("c3"));        // oldest control message is evicted
+
+    std::vector<SharedPayload> control, updates;
+    channel.take(control, updates);
+    CHECK(updates.size() == 2 && *updates[0] == "r2" && *updates[1] == "t1");
+    CHECK(control.size() == 2 && *control[0] == "c2" && *control[1] == "c3");
+    CHECK(!channel.hasPending());
+}
+
+void testCapacityAndPlainConnections() {
+    FanoutPolicy policy;
+    policy.maxConnections = 2;
+    policy.senderThreads = 1;
+    WsFanout<PlainConnection> fanout(policy, concatenate);
+    fanout.start(ThreadRoleConfig{});
+
+    PlainConnection first, second, third;
+    CHECK(fanout.add(&first));
+    CHECK(!fanout.full());
+    CHECK(fanout.add(&second));
+    CHECK(fanout.full());
+    CHECK(!fanout.add(&third));
+    CHECK(fanout.size() == 2);
+
+    fanout.publish({{"SBIN", std::make_shared<const std::string>("s1")}});
+    fanout.broadcastControl(std::make_shared<const std::string>("alert"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    fanout.remove(&first);
+    fanout.remove(&second);
+    fanout.stop();
+    for (PlainConnection* conn : {&first, &second}) {
+        CHECK(conn->frames.size() == 2);
+        CHECK(std::find(conn->frames.begin(), conn->frames.end(), "alert") != conn->frames.end());
+        CHECK(std::find(conn->frames.begin(), conn->frames.end(), "s1") != conn->frames.end());
+    }
+    CHECK(third.frames.empty());
+}
+
+}
+
+int main() {
+    testConflation();
+    testCapacityAndPlainConnections();
+    testSlowConsumer(SlowConsumerAction::Drop);
+    testSlowConsumer(SlowConsumerAction::Downgrade);
+    std::printf("ws_fanout: all checks passed\n");
+    return 0;
+}